@@ -10,10 +10,11 @@ set -euo pipefail
 
 usage() {
   cat <<EOF
-Usage: $(basename "$0") [--without-routing] [--keep-stage] [--debug] [--asan]
+Usage: $(basename "$0") [--without-routing] [--large-index] [--keep-stage] [--debug] [--asan]
 
 Options:
   --without-routing  Build without routing backends (matrix-only)
+  --large-index    Use 32-bit indices for more than 65,535 locations/tasks
   --debug          Build with debug symbols and no NDEBUG (g, O0, frame pointers)
   --asan           Add Address/UB sanitizers (implies debug-friendly flags)
   --keep-stage     Keep the staging directory after build (for debugging)
@@ -27,12 +28,14 @@ EOF
 }
 
 WITH_ROUTING=true
+LARGE_INDEX=false
 KEEP_STAGE=false
 DEBUG_BUILD=false
 WITH_ASAN=false
 while [[ $# -gt 0 ]]; do
   case "$1" in
     --without-routing) WITH_ROUTING=false; shift ;;
+    --large-index)  LARGE_INDEX=true; shift ;;
     --debug)        DEBUG_BUILD=true; shift ;;
     --asan)         WITH_ASAN=true; shift ;;
     --keep-stage)   KEEP_STAGE=true; shift ;;
@@ -94,14 +97,14 @@ fi
 # Compose compiler flags
 if [[ "${DEBUG_BUILD}" == "true" ]]; then
   echo "[build-macos] Building in DEBUG mode"
-  CXXFLAGS_OVERRIDE="-MMD -MP -I. -std=c++20 -Wextra -Wpedantic -Wall -g -O0 -fno-omit-frame-pointer -DASIO_STANDALONE -DUSE_ROUTING=${DUSE}"
+  CXXFLAGS_OVERRIDE="-MMD -MP -I. -std=c++20 -Wextra -Wpedantic -Wall -g -O0 -fno-omit-frame-pointer -DASIO_STANDALONE -DUSE_ROUTING=${DUSE} -DUSE_LARGE_INDEX=${LARGE_INDEX}"
   if [[ "${WITH_ASAN}" == "true" ]]; then
     echo "[build-macos] Enabling ASAN/UBSAN"
     CXXFLAGS_OVERRIDE="${CXXFLAGS_OVERRIDE} -fsanitize=address,undefined"
   fi
 else
   # Release-like defaults (matches devbox’s -DNDEBUG)
-  CXXFLAGS_OVERRIDE="-MMD -MP -I. -std=c++20 -Wextra -Wpedantic -Wall -O3 -DASIO_STANDALONE -DUSE_ROUTING=${DUSE} -DNDEBUG"
+  CXXFLAGS_OVERRIDE="-MMD -MP -I. -std=c++20 -Wextra -Wpedantic -Wall -O3 -DASIO_STANDALONE -DUSE_ROUTING=${DUSE} -DUSE_LARGE_INDEX=${LARGE_INDEX} -DNDEBUG"
 fi
 
 if [[ "${WITH_ROUTING}" != "true" ]]; then
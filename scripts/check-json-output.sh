@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+
+set -euo pipefail
+
+# Compare JSON output of two vroom builds, e.g. before and after a
+# change to output code.
+# - Each input is solved, then checked in plan mode (-c) with routes
+#   from the reference solution and tightened constraints so that
+#   violations are reported.
+# - With MATRIX_CACHE=1, every run gets its own --matrix-cache
+#   directory so that computing_times.matrix_cache is reported.
+# - Outputs must be byte-identical once computing_times values are set
+#   to 0 (keys and their order are still compared).
+# - Extra arguments are passed to both builds, e.g. "-g -a car:localhost"
+#   to cover geometry and matrices computing times with a routing
+#   engine.
+
+usage() {
+  cat <<EOF
+Usage: $(basename "$0") REFERENCE_VROOM VROOM [vroom args...]
+
+Inputs are docs/example_*.json, or the files listed in the INPUTS
+environment variable. Both builds have to support the vroom args.
+EOF
+}
+
+if [[ $# -lt 2 ]]; then
+  usage
+  exit 1
+fi
+
+REFERENCE=$1
+CANDIDATE=$2
+shift 2
+
+ROOT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+INPUTS=${INPUTS:-$(ls "$ROOT_DIR"/docs/example_*.json | grep -v "_sol.json")}
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+RUN=0
+run() {
+  local bin=$1 input=$2 output=$3
+  shift 3
+  RUN=$((RUN + 1))
+  if [[ ${MATRIX_CACHE:-0} = 1 ]]; then
+    mkdir "$WORK_DIR/cache_$RUN"
+    set -- --matrix-cache "$WORK_DIR/cache_$RUN" "$@"
+  fi
+  # Errors are part of the output to compare.
+  "$bin" -i "$input" "$@" > "$output" || true
+}
+
+normalize() {
+  jq -c 'if .summary then
+           .summary.computing_times |= walk(if type == "number" then 0 else . end)
+         else . end' "$1"
+}
+
+FAILED=0
+compare() {
+  local name=$1
+  if ! diff <(normalize "$WORK_DIR/reference.json") \
+            <(normalize "$WORK_DIR/candidate.json") > "$WORK_DIR/diff"; then
+    echo "FAIL: $name"
+    cat "$WORK_DIR/diff"
+    FAILED=1
+  else
+    echo "OK: $name"
+  fi
+}
+
+for input in $INPUTS; do
+  name=$(basename "$input")
+
+  run "$REFERENCE" "$input" "$WORK_DIR/reference.json" "$@"
+  run "$CANDIDATE" "$input" "$WORK_DIR/candidate.json" "$@"
+  compare "$name"
+
+  if ! jq -e '.routes' "$WORK_DIR/reference.json" > /dev/null; then
+    continue
+  fi
+
+  # Plan mode on reference routes, with one task per vehicle and
+  # unreachable time windows so that steps get violations.
+  jq --slurpfile sol "$WORK_DIR/reference.json" '
+    .vehicles |= map(. as $v | .max_tasks = 1 | .steps = [
+      $sol[0].routes[] | select(.vehicle == $v.id) | .steps[]
+      | {type} + (if .type == "start" or .type == "end" then {} else {id} end)
+    ])
+    | if .jobs then .jobs[].time_windows = [[0, 1]] else . end' \
+    "$input" > "$WORK_DIR/plan.json"
+
+  run "$REFERENCE" "$WORK_DIR/plan.json" "$WORK_DIR/reference.json" -c "$@"
+  run "$CANDIDATE" "$WORK_DIR/plan.json" "$WORK_DIR/candidate.json" -c "$@"
+  compare "$name (plan mode)"
+done
+
+exit $FAILED
@@ -8,7 +8,10 @@ All rights reserved (see LICENSE).
 */
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <optional>
+#include <queue>
 
 #include "algorithms/heuristics/heuristics.h"
 #include "structures/vroom/tw_route.h"
@@ -16,6 +19,30 @@ All rights reserved (see LICENSE).
 
 namespace vroom::heuristics {
 
+// Below this number of iterations per thread, splitting work is not
+// worth the synchronization overhead.
+constexpr std::size_t MIN_BLOCK_SIZE = 64;
+
+// Call f(begin, end) for contiguous blocks covering [0, n), spread
+// across up to nb_threads threads from input thread pool.
+template <class F>
+void for_each_block(const Input& input,
+                    unsigned nb_threads,
+                    std::size_t n,
+                    const F& f) {
+  const auto nb_blocks =
+    std::min(static_cast<std::size_t>(nb_threads), n / MIN_BLOCK_SIZE);
+  if (nb_blocks < 2) {
+    f(0, n);
+    return;
+  }
+
+  input.thread_pool().parallel_for(
+    nb_blocks,
+    [&](std::size_t b) { f(b * n / nb_blocks, (b + 1) * n / nb_blocks); },
+    nb_threads);
+}
+
 // Add seed job to route if required and return current cost of route
 // without vehicle fixed cost.
 template <class Route>
@@ -81,7 +108,8 @@ inline void seed_route(const Input& input,
                                                          current_job.delivery,
                                                          0);
     if (is_pickup) {
-      std::vector<Index> p_d({job_rank, static_cast<Index>(job_rank + 1)});
+      const std::array<Index, 2> p_d({job_rank,
+                                      static_cast<Index>(job_rank + 1)});
       is_valid = is_valid && route.is_valid_addition_for_tw(input,
                                                             input.zero_amount(),
                                                             p_d.begin(),
@@ -156,7 +184,7 @@ inline void seed_route(const Input& input,
                   (route_budget_sum + budget_added);
       }
       if (allowed) {
-        std::vector<Index> p_d(
+        const std::array<Index, 2> p_d(
           {best_job_rank, static_cast<Index>(best_job_rank + 1)});
         route.replace(input, input.zero_amount(), p_d.begin(), p_d.end(), 0, 0);
         unassigned.erase(best_job_rank);
@@ -181,6 +209,31 @@ template <class Route> struct UnassignedCosts {
                               std::numeric_limits<Cost>::max()),
       min_unassigned_to_route(input.jobs.size(),
                               std::numeric_limits<Cost>::max()) {
+    const auto cost_class = input.vehicle_cost_class(route.v_rank);
+    std::vector<unsigned char> is_in_route(input.jobs.size(), false);
+    for (const auto j : route.route) {
+      is_in_route[j] = true;
+    }
+
+    // Min cost from (resp. to) job_rank to (resp. from) route jobs
+    // based on nearest jobs lists, if any of them is in route. Only
+    // worth it for routes longer than lists.
+    const bool use_nearest_jobs = NEAREST_JOBS_K < route.size();
+    auto get_nearest_cost = [&](Index job_rank,
+                                bool from) -> std::optional<Cost> {
+      const auto nearest = from ? input.nearest_jobs_from(cost_class, job_rank)
+                                : input.nearest_jobs_to(cost_class, job_rank);
+      const auto job_index = input.jobs[job_rank].index();
+      for (const auto j : nearest) {
+        if (static_cast<bool>(is_in_route[j])) {
+          const auto j_index = input.jobs[j].index();
+          return from ? vehicle.cost(job_index, j_index)
+                      : vehicle.cost(j_index, job_index);
+        }
+      }
+      return std::nullopt;
+    };
+
     for (const auto job_rank : unassigned) {
       const auto unassigned_job_index = input.jobs[job_rank].index();
 
@@ -197,6 +250,19 @@ template <class Route> struct UnassignedCosts {
         min_unassigned_to_route[job_rank] = job_to_end;
       }
 
+      if (use_nearest_jobs) {
+        const auto to_unassigned = get_nearest_cost(job_rank, false);
+        const auto from_unassigned = get_nearest_cost(job_rank, true);
+        if (to_unassigned.has_value() && from_unassigned.has_value()) {
+          min_route_to_unassigned[job_rank] =
+            std::min(min_route_to_unassigned[job_rank], to_unassigned.value());
+          min_unassigned_to_route[job_rank] =
+            std::min(min_unassigned_to_route[job_rank],
+                     from_unassigned.value());
+          continue;
+        }
+      }
+
       for (const auto j : route.route) {
         const auto job_index = input.jobs[j].index();
 
@@ -285,12 +351,34 @@ template <class Route> struct UnassignedCosts {
   }
 };
 
+// Best insertion found for a job in a route.
+struct Insertion {
+  double cost{std::numeric_limits<double>::max()};
+  Index r{0};
+  Index pickup_r{0};
+  Index delivery_r{0};
+  Amount modified_delivery;
+  Eval eval;
+};
+
+// Lowest addition costs for a job across ranks in a route, regardless
+// of validity. For shipments, pickup and delivery costs are for
+// separate additions while pickup_delivery is for adding both in a
+// row.
+struct MinAdditionCosts {
+  Cost single{std::numeric_limits<Cost>::max()};
+  Cost pickup{std::numeric_limits<Cost>::max()};
+  Cost delivery{std::numeric_limits<Cost>::max()};
+  Cost pickup_delivery{std::numeric_limits<Cost>::max()};
+};
+
 template <class Route>
 inline Eval fill_route(const Input& input,
                        Route& route,
                        std::set<Index>& unassigned,
                        const std::vector<Cost>& regrets,
-                       double lambda) {
+                       double lambda,
+                       unsigned nb_threads) {
   const auto v_rank = route.v_rank;
   const auto& vehicle = input.vehicles[v_rank];
 
@@ -308,334 +396,514 @@ inline Eval fill_route(const Input& input,
   // Store bounds to be able to cut out some loops.
   UnassignedCosts unassigned_costs(input, route, unassigned);
 
-  bool keep_going = true;
-  while (keep_going) {
-    keep_going = false;
-    double best_cost = std::numeric_limits<double>::max();
-    Index best_job_rank = 0;
-    Index best_r = 0;
-    Index best_pickup_r = 0;
-    Index best_delivery_r = 0;
-    Amount best_modified_delivery = input.zero_amount();
-    Eval best_eval;
+  // Pickup multipliers make pickup insertion costs depend on the
+  // whole route, not only on surrounding edges.
+  const bool has_pickup_multipliers =
+    vehicle.initial_pickup_cost_multiplier != 1.0 ||
+    vehicle.non_initial_pickup_cost_multiplier != 1.0;
+
+  // Addition costs only depend on surrounding edges, so minimums are
+  // refreshed upon each job evaluation and only updated for new ranks
+  // after each route change.
+  std::vector<MinAdditionCosts> min_additions(input.jobs.size());
+
+  auto update_min_additions = [&](const Index job_rank, const Index rank) {
+    auto& min_costs = min_additions[job_rank];
+    if (input.jobs[job_rank].type == JOB_TYPE::SINGLE) {
+      min_costs.single =
+        std::min(min_costs.single,
+                 utils::addition_cost(input, job_rank, v_rank, route.route, rank)
+                   .cost);
+    } else {
+      min_costs.pickup =
+        std::min(min_costs.pickup,
+                 utils::addition_cost(input, job_rank, v_rank, route.route, rank)
+                   .cost);
+      min_costs.delivery = std::min(min_costs.delivery,
+                                    utils::addition_cost(input,
+                                                         job_rank + 1,
+                                                         v_rank,
+                                                         route.route,
+                                                         rank)
+                                      .cost);
+      min_costs.pickup_delivery = std::min(min_costs.pickup_delivery,
+                                           utils::addition_cost(input,
+                                                                job_rank,
+                                                                v_rank,
+                                                                route.route,
+                                                                rank,
+                                                                rank + 1)
+                                             .cost);
+    }
+  };
 
-    for (const auto job_rank : unassigned) {
-      if (!input.vehicle_ok_with_job(v_rank, job_rank)) {
-        continue;
-      }
+  // Best insertion for job_rank in current route, with a cost of
+  // std::numeric_limits<double>::max() if none is valid. Empty if job
+  // is skipped without looking at insertion positions.
+  auto get_best_insertion =
+    [&](const Index job_rank) -> std::optional<Insertion> {
+    Insertion best;
 
-      const auto& current_job = input.jobs[job_rank];
+    const auto& current_job = input.jobs[job_rank];
 
-      if (current_job.type == JOB_TYPE::DELIVERY) {
-        continue;
+    if (current_job.type == JOB_TYPE::SINGLE &&
+        route.size() + 1 <= vehicle.max_tasks) {
+
+      if (std::isinf(unassigned_costs.get_insertion_lower_bound(job_rank))) {
+        // No usable bound, such jobs are skipped.
+        return std::nullopt;
       }
 
-      if (current_job.type == JOB_TYPE::SINGLE &&
-          route.size() + 1 <= vehicle.max_tasks) {
+      auto& min_costs = min_additions[job_rank];
+      min_costs = MinAdditionCosts();
 
-        if (best_cost < unassigned_costs.get_insertion_lower_bound(job_rank) -
-                          lambda * static_cast<double>(regrets[job_rank])) {
-          // Bypass going through whole route if we're sure insertion
-          // cost is not good enough.
+      for (Index r = 0; r <= route.size(); ++r) {
+        if (input.pinned_soft_timing() && input.pinned_violation_budget() == 0 &&
+            r < route.size() && input.jobs[route.route[r]].pinned) {
           continue;
         }
+        const auto current_eval =
+          utils::addition_cost(input, job_rank, v_rank, route.route, r);
+
+        const double current_cost = static_cast<double>(current_eval.cost) -
+          lambda * static_cast<double>(regrets[job_rank]);
+        min_costs.single = std::min(min_costs.single, current_eval.cost);
+
+        if (current_cost < best.cost &&
+            (vehicle.ok_for_range_bounds(route_eval + current_eval)) &&
+            route.is_valid_addition_for_capacity(input,
+                                                 current_job.pickup,
+                                                 current_job.delivery,
+                                                 r) &&
+            route.is_valid_addition_for_tw(input, job_rank, r)) {
+          best.cost = current_cost;
+          best.r = r;
+          best.eval = current_eval;
+        }
+      }
+    }
 
-        for (Index r = 0; r <= route.size(); ++r) {
-          if (input.pinned_soft_timing() && input.pinned_violation_budget() == 0 &&
-              r < route.size() && input.jobs[route.route[r]].pinned) {
-            continue;
-          }
-          const auto current_eval =
-            utils::addition_cost(input, job_rank, v_rank, route.route, r);
-
-          const double current_cost = static_cast<double>(current_eval.cost) -
-            lambda * static_cast<double>(regrets[job_rank]);
+    if (current_job.type == JOB_TYPE::PICKUP &&
+        route.size() + 2 <= vehicle.max_tasks) {
 
-          if (current_cost < best_cost &&
-              (vehicle.ok_for_range_bounds(route_eval + current_eval)) &&
-              route.is_valid_addition_for_capacity(input,
-                                                   current_job.pickup,
-                                                   current_job.delivery,
-                                                   r) &&
-              route.is_valid_addition_for_tw(input, job_rank, r)) {
-            best_cost = current_cost;
-            best_job_rank = job_rank;
-            best_r = r;
-            best_eval = current_eval;
-          }
-        }
+      if (std::isinf(
+            unassigned_costs.get_pd_insertion_lower_bound(input, job_rank))) {
+        // No usable bound, such jobs are skipped.
+        return std::nullopt;
       }
 
-      if (current_job.type == JOB_TYPE::PICKUP &&
-          route.size() + 2 <= vehicle.max_tasks) {
+      auto& min_costs = min_additions[job_rank];
+      min_costs = MinAdditionCosts();
+
+      // Pre-compute cost of addition for matching delivery.
+      std::vector<Eval> d_adds(route.route.size() + 1);
+      std::vector<unsigned char> valid_delivery_insertions(
+        route.route.size() + 1);
+
+      for (unsigned d_rank = 0; d_rank <= route.route.size(); ++d_rank) {
+        d_adds[d_rank] =
+          utils::addition_cost(input, job_rank + 1, v_rank, route.route, d_rank);
+        min_costs.delivery = std::min(min_costs.delivery, d_adds[d_rank].cost);
+        min_costs.pickup_delivery = std::min(min_costs.pickup_delivery,
+                                             utils::addition_cost(input,
+                                                                  job_rank,
+                                                                  v_rank,
+                                                                  route.route,
+                                                                  d_rank,
+                                                                  d_rank + 1)
+                                               .cost);
+        valid_delivery_insertions[d_rank] =
+          route.is_valid_addition_for_tw_without_max_load(input,
+                                                          job_rank + 1,
+                                                          d_rank);
+      }
 
-        if (best_cost <
-            unassigned_costs.get_pd_insertion_lower_bound(input, job_rank) -
-              lambda * static_cast<double>(regrets[job_rank])) {
-          // Bypass going through whole route if we're sure insertion
-          // cost is not good enough.
+      for (Index pickup_r = 0; pickup_r <= route.size(); ++pickup_r) {
+        if (input.pinned_soft_timing() && input.pinned_violation_budget() == 0 &&
+            pickup_r < route.size() && input.jobs[route.route[pickup_r]].pinned) {
           continue;
         }
-
-        // Pre-compute cost of addition for matching delivery.
-        std::vector<Eval> d_adds(route.route.size() + 1);
-        std::vector<unsigned char> valid_delivery_insertions(
-          route.route.size() + 1);
-
-        for (unsigned d_rank = 0; d_rank <= route.route.size(); ++d_rank) {
-          d_adds[d_rank] =
-            utils::addition_cost(input, job_rank + 1, v_rank, route.route, d_rank);
-          valid_delivery_insertions[d_rank] =
-            route.is_valid_addition_for_tw_without_max_load(input,
-                                                            job_rank + 1,
-                                                            d_rank);
+        const auto p_add = utils::addition_cost(input,
+                                                job_rank,
+                                                v_rank,
+                                                route.route,
+                                                pickup_r);
+        min_costs.pickup = std::min(min_costs.pickup, p_add.cost);
+
+        if (!route.is_valid_addition_for_load(input,
+                                              current_job.pickup,
+                                              pickup_r) ||
+            !route.is_valid_addition_for_tw_without_max_load(input,
+                                                             job_rank,
+                                                             pickup_r)) {
+          continue;
         }
 
-        for (Index pickup_r = 0; pickup_r <= route.size(); ++pickup_r) {
-          if (input.pinned_soft_timing() && input.pinned_violation_budget() == 0 &&
-              pickup_r < route.size() && input.jobs[route.route[pickup_r]].pinned) {
-            continue;
+        // Build replacement sequence for current insertion.
+        std::vector<Index> modified_with_pd;
+        modified_with_pd.reserve(route.size() - pickup_r + 2);
+        modified_with_pd.push_back(job_rank);
+
+        Amount modified_delivery = input.zero_amount();
+
+        for (Index delivery_r = pickup_r; delivery_r <= route.size();
+             ++delivery_r) {
+          // Update state variables along the way before potential
+          // early abort.
+          if (pickup_r < delivery_r) {
+            modified_with_pd.push_back(route.route[delivery_r - 1]);
+            const auto& new_modified_job =
+              input.jobs[route.route[delivery_r - 1]];
+            if (new_modified_job.type == JOB_TYPE::SINGLE) {
+              modified_delivery += new_modified_job.delivery;
+            }
           }
-          const auto p_add = utils::addition_cost(input,
-                                                  job_rank,
-                                                  v_rank,
-                                                  route.route,
-                                                  pickup_r);
-
-          if (!route.is_valid_addition_for_load(input,
-                                                current_job.pickup,
-                                                pickup_r) ||
-              !route.is_valid_addition_for_tw_without_max_load(input,
-                                                               job_rank,
-                                                               pickup_r)) {
+
+          if (!static_cast<bool>(valid_delivery_insertions[delivery_r])) {
             continue;
           }
 
-          // Build replacement sequence for current insertion.
-          std::vector<Index> modified_with_pd;
-          modified_with_pd.reserve(route.size() - pickup_r + 2);
-          modified_with_pd.push_back(job_rank);
-
-          Amount modified_delivery = input.zero_amount();
-
-          for (Index delivery_r = pickup_r; delivery_r <= route.size();
-               ++delivery_r) {
-            // Update state variables along the way before potential
-            // early abort.
-            if (pickup_r < delivery_r) {
-              modified_with_pd.push_back(route.route[delivery_r - 1]);
-              const auto& new_modified_job =
-                input.jobs[route.route[delivery_r - 1]];
-              if (new_modified_job.type == JOB_TYPE::SINGLE) {
-                modified_delivery += new_modified_job.delivery;
-              }
-            }
-
-            if (!static_cast<bool>(valid_delivery_insertions[delivery_r])) {
-              continue;
-            }
-
-            Eval current_eval;
-            if (pickup_r == delivery_r) {
-              current_eval = utils::addition_cost(input,
-                                                  job_rank,
-                                                  v_rank,
-                                                  route.route,
-                                                  pickup_r,
-                                                  pickup_r + 1);
-            } else {
-              current_eval = p_add + d_adds[delivery_r];
-            }
-
-            auto adjusted_eval = current_eval;
-            bool skip_due_to_penalty = false;
-            {
-              const double I = vehicle.initial_pickup_cost_multiplier;
-              const double N = vehicle.non_initial_pickup_cost_multiplier;
-              if (I != 1.0 || N != 1.0) {
-                std::optional<std::size_t> first_pickup_rank;
-                for (std::size_t rr = 0; rr < route.route.size(); ++rr) {
-                  if (input.jobs[route.route[rr]].type == JOB_TYPE::PICKUP) {
-                    first_pickup_rank = rr;
-                    break;
-                  }
-                }
+          Eval current_eval;
+          if (pickup_r == delivery_r) {
+            current_eval = utils::addition_cost(input,
+                                                job_rank,
+                                                v_rank,
+                                                route.route,
+                                                pickup_r,
+                                                pickup_r + 1);
+          } else {
+            current_eval = p_add + d_adds[delivery_r];
+          }
 
-                Index pred_index;
-                bool has_pred = false;
-                if (pickup_r > 0) {
-                  pred_index = input.jobs[route.route[pickup_r - 1]].index();
-                  has_pred = true;
-                } else if (vehicle.has_start()) {
-                  pred_index = vehicle.start.value().index();
-                  has_pred = true;
+          auto adjusted_eval = current_eval;
+          bool skip_due_to_penalty = false;
+          {
+            const double I = vehicle.initial_pickup_cost_multiplier;
+            const double N = vehicle.non_initial_pickup_cost_multiplier;
+            if (I != 1.0 || N != 1.0) {
+              std::optional<std::size_t> first_pickup_rank;
+              for (std::size_t rr = 0; rr < route.route.size(); ++rr) {
+                if (input.jobs[route.route[rr]].type == JOB_TYPE::PICKUP) {
+                  first_pickup_rank = rr;
+                  break;
                 }
-                if (has_pred) {
-                  const Cost edge_cost =
-                    vehicle.cost(pred_index, input.jobs[job_rank].index());
+              }
 
-                  if (!first_pickup_rank.has_value()) {
-                    adjusted_eval.cost +=
-                      static_cast<Cost>(std::round(edge_cost * (I - 1.0)));
-                  } else if (pickup_r <= first_pickup_rank.value()) {
-                    adjusted_eval.cost +=
-                      static_cast<Cost>(std::round(edge_cost * (I - 1.0)));
-
-                    const auto old_first_rank = first_pickup_rank.value();
-                    const auto old_first_jr = route.route[old_first_rank];
-                    Index old_first_pred;
-                    bool has_old_pred = false;
-                    if (old_first_rank > 0) {
-                      old_first_pred =
-                        input.jobs[route.route[old_first_rank - 1]].index();
-                      has_old_pred = true;
-                    } else if (vehicle.has_start()) {
-                      old_first_pred = vehicle.start.value().index();
-                      has_old_pred = true;
-                    }
-                    if (has_old_pred) {
-                      const Cost old_first_edge =
-                        vehicle.cost(old_first_pred,
-                                     input.jobs[old_first_jr].index());
-                      adjusted_eval.cost +=
-                        static_cast<Cost>(std::round(old_first_edge * (N - I)));
-                    }
-                  } else {
+              Index pred_index;
+              bool has_pred = false;
+              if (pickup_r > 0) {
+                pred_index = input.jobs[route.route[pickup_r - 1]].index();
+                has_pred = true;
+              } else if (vehicle.has_start()) {
+                pred_index = vehicle.start.value().index();
+                has_pred = true;
+              }
+              if (has_pred) {
+                const Cost edge_cost =
+                  vehicle.cost(pred_index, input.jobs[job_rank].index());
+
+                if (!first_pickup_rank.has_value()) {
+                  adjusted_eval.cost +=
+                    static_cast<Cost>(std::round(edge_cost * (I - 1.0)));
+                } else if (pickup_r <= first_pickup_rank.value()) {
+                  adjusted_eval.cost +=
+                    static_cast<Cost>(std::round(edge_cost * (I - 1.0)));
+
+                  const auto old_first_rank = first_pickup_rank.value();
+                  const auto old_first_jr = route.route[old_first_rank];
+                  Index old_first_pred;
+                  bool has_old_pred = false;
+                  if (old_first_rank > 0) {
+                    old_first_pred =
+                      input.jobs[route.route[old_first_rank - 1]].index();
+                    has_old_pred = true;
+                  } else if (vehicle.has_start()) {
+                    old_first_pred = vehicle.start.value().index();
+                    has_old_pred = true;
+                  }
+                  if (has_old_pred) {
+                    const Cost old_first_edge =
+                      vehicle.cost(old_first_pred,
+                                   input.jobs[old_first_jr].index());
                     adjusted_eval.cost +=
-                      static_cast<Cost>(std::round(edge_cost * (N - 1.0)));
+                      static_cast<Cost>(std::round(old_first_edge * (N - I)));
                   }
+                } else {
+                  adjusted_eval.cost +=
+                    static_cast<Cost>(std::round(edge_cost * (N - 1.0)));
+                }
 
-                  // Only penalize if this pickup is at a location not
-                  // already served by an existing pickup on the route.
-                  // Same-merchant shipments (same pickup location) are free
-                  // to share a route.
-                  if (first_pickup_rank.has_value()) {
-                    const auto new_pickup_loc = input.jobs[job_rank].index();
-                    bool same_loc_exists = false;
-                    for (const auto jr : route.route) {
-                      if (input.jobs[jr].type == JOB_TYPE::PICKUP &&
-                          input.jobs[jr].index() == new_pickup_loc) {
-                        same_loc_exists = true;
-                        break;
-                      }
+                // Only penalize if this pickup is at a location not
+                // already served by an existing pickup on the route.
+                // Same-merchant shipments (same pickup location) are free
+                // to share a route.
+                if (first_pickup_rank.has_value()) {
+                  const auto new_pickup_loc = input.jobs[job_rank].index();
+                  bool same_loc_exists = false;
+                  for (const auto jr : route.route) {
+                    if (input.jobs[jr].type == JOB_TYPE::PICKUP &&
+                        input.jobs[jr].index() == new_pickup_loc) {
+                      same_loc_exists = true;
+                      break;
                     }
-                    if (!same_loc_exists) {
-                      const Cost penalty_portion =
-                        adjusted_eval.cost - current_eval.cost;
-                      if (penalty_portion > 0 &&
-                          penalty_portion > vehicle.fixed_cost()) {
-                        skip_due_to_penalty = true;
-                      }
+                  }
+                  if (!same_loc_exists) {
+                    const Cost penalty_portion =
+                      adjusted_eval.cost - current_eval.cost;
+                    if (penalty_portion > 0 &&
+                        penalty_portion > vehicle.fixed_cost()) {
+                      skip_due_to_penalty = true;
                     }
                   }
                 }
               }
             }
+          }
 
-            if (skip_due_to_penalty) {
-              break;
-            }
+          if (skip_due_to_penalty) {
+            break;
+          }
 
-            const double current_cost =
-              adjusted_eval.cost -
-              lambda * static_cast<double>(regrets[job_rank]);
-
-            if (current_cost < best_cost) {
-              modified_with_pd.push_back(job_rank + 1);
-
-              // Update best cost depending on validity.
-              const bool valid =
-                (vehicle.ok_for_range_bounds(route_eval + current_eval)) &&
-                route
-                  .is_valid_addition_for_capacity_inclusion(input,
-                                                            modified_delivery,
-                                                            modified_with_pd
-                                                              .begin(),
-                                                            modified_with_pd
-                                                              .end(),
-                                                            pickup_r,
-                                                            delivery_r) &&
-                route.is_valid_addition_for_tw(input,
-                                               modified_delivery,
-                                               modified_with_pd.begin(),
-                                               modified_with_pd.end(),
-                                               pickup_r,
-                                               delivery_r);
-
-              modified_with_pd.pop_back();
-
-              if (valid) {
-                best_cost = current_cost;
-                best_job_rank = job_rank;
-                best_pickup_r = pickup_r;
-                best_delivery_r = delivery_r;
-                best_modified_delivery = modified_delivery;
-                best_eval = current_eval;
-              }
+          const double current_cost =
+            adjusted_eval.cost -
+            lambda * static_cast<double>(regrets[job_rank]);
+
+          if (current_cost < best.cost) {
+            modified_with_pd.push_back(job_rank + 1);
+
+            // Update best cost depending on validity.
+            const bool valid =
+              (vehicle.ok_for_range_bounds(route_eval + current_eval)) &&
+              route
+                .is_valid_addition_for_capacity_inclusion(input,
+                                                          modified_delivery,
+                                                          modified_with_pd
+                                                            .begin(),
+                                                          modified_with_pd
+                                                            .end(),
+                                                          pickup_r,
+                                                          delivery_r) &&
+              route.is_valid_addition_for_tw(input,
+                                             modified_delivery,
+                                             modified_with_pd.begin(),
+                                             modified_with_pd.end(),
+                                             pickup_r,
+                                             delivery_r);
+
+            modified_with_pd.pop_back();
+
+            if (valid) {
+              best.cost = current_cost;
+              best.pickup_r = pickup_r;
+              best.delivery_r = delivery_r;
+              best.modified_delivery = modified_delivery;
+              best.eval = current_eval;
             }
           }
         }
       }
     }
+    return best;
+  };
+
+  // Lower bound for the cost of any insertion of job_rank in current
+  // route, valid or not.
+  auto get_lower_bound = [&](const Index job_rank) {
+    const auto& min_costs = min_additions[job_rank];
+    double bound;
+    if (input.jobs[job_rank].type == JOB_TYPE::SINGLE) {
+      bound = static_cast<double>(min_costs.single);
+    } else {
+      if (has_pickup_multipliers) {
+        return -std::numeric_limits<double>::infinity();
+      }
+      bound = std::min(static_cast<double>(min_costs.pickup) +
+                         static_cast<double>(min_costs.delivery),
+                       static_cast<double>(min_costs.pickup_delivery));
+    }
+    return bound - lambda * static_cast<double>(regrets[job_rank]);
+  };
+
+  // Jobs are evaluated lazily: each candidate job is keyed with
+  // either its best insertion cost, or a lower bound if the route
+  // changed since it was last evaluated. Only jobs at the top of the
+  // heap are (re-)evaluated until the top one is up to date, which
+  // yields the same choice as evaluating all jobs, ties being broken
+  // on job rank.
+  using Candidate = std::pair<double, Index>;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> heap;
+  std::vector<Index> candidates;
+  std::vector<unsigned char> is_candidate(input.jobs.size(), false);
+  std::vector<double> keys(input.jobs.size());
+  std::vector<Insertion> insertions(input.jobs.size());
+  // Route version each insertion was evaluated for, 0 meaning never.
+  std::vector<unsigned> evaluated_version(input.jobs.size(), 0);
+  unsigned version = 1;
 
-    if (best_cost < std::numeric_limits<double>::max()) {
-      const auto& best_job = input.jobs[best_job_rank];
-      if (best_job.type == JOB_TYPE::SINGLE) {
-        route.add(input, best_job_rank, best_r);
-        unassigned.erase(best_job_rank);
-        // Update budget trackers
-        if (input.include_action_time_in_budget()) {
-          const auto d = utils::action_time_delta_single(input,
-                                                        vehicle,
-                                                        route.route,
-                                                        best_job_rank,
-                                                        best_r);
-          route_action_cost += utils::action_cost_from_duration(vehicle, d);
-        }
-        keep_going = true;
+  for (const auto job_rank : unassigned) {
+    if (input.vehicle_ok_with_job(v_rank, job_rank) &&
+        input.jobs[job_rank].type != JOB_TYPE::DELIVERY) {
+      candidates.push_back(job_rank);
+      is_candidate[job_rank] = true;
+    }
+  }
+
+  // Candidate scans only update data for the job at hand, so they
+  // are spread across threads, heap updates being done afterwards.
+  for_each_block(input,
+                 nb_threads,
+                 candidates.size(),
+                 [&](std::size_t begin, std::size_t end) {
+                   for (auto i = begin; i < end; ++i) {
+                     const auto job_rank = candidates[i];
+                     for (Index r = 0; r <= route.size(); ++r) {
+                       update_min_additions(job_rank, r);
+                     }
+                     keys[job_rank] = get_lower_bound(job_rank);
+                   }
+                 });
+
+  for (const auto job_rank : candidates) {
+    heap.emplace(keys[job_rank], job_rank);
+  }
 
-        unassigned_costs.update_max_edge(input, route);
-        unassigned_costs.update_min_costs(input, unassigned, best_job.index());
+  std::vector<Index> inserted_ranks;
+  std::vector<double> bounds;
+  while (true) {
+    bool found = false;
+    Index best_job_rank = 0;
+    while (!heap.empty()) {
+      const auto [key, job_rank] = heap.top();
+      if (!static_cast<bool>(is_candidate[job_rank]) || key != keys[job_rank]) {
+        // Outdated heap entry.
+        heap.pop();
+        continue;
       }
-      if (best_job.type == JOB_TYPE::PICKUP) {
-        std::vector<Index> modified_with_pd;
-        modified_with_pd.reserve(best_delivery_r - best_pickup_r + 2);
-        modified_with_pd.push_back(best_job_rank);
-
-        std::copy(route.route.begin() + best_pickup_r,
-                  route.route.begin() + best_delivery_r,
-                  std::back_inserter(modified_with_pd));
-        modified_with_pd.push_back(best_job_rank + 1);
-
-        route.replace(input,
-                      best_modified_delivery,
-                      modified_with_pd.begin(),
-                      modified_with_pd.end(),
-                      best_pickup_r,
-                      best_delivery_r);
-        unassigned.erase(best_job_rank);
-        unassigned.erase(best_job_rank + 1);
-        // Update budget trackers
-        if (input.include_action_time_in_budget()) {
-          const auto d = utils::action_time_delta_pd(input,
-                                                    vehicle,
-                                                    route.route,
-                                                    best_job_rank,
-                                                    best_pickup_r,
-                                                    best_delivery_r);
-          route_action_cost += utils::action_cost_from_duration(vehicle, d);
+
+      if (evaluated_version[job_rank] == version) {
+        found = true;
+        best_job_rank = job_rank;
+        break;
+      }
+
+      heap.pop();
+      if (auto insertion = get_best_insertion(job_rank);
+          insertion.has_value()) {
+        insertions[job_rank] = std::move(insertion.value());
+        evaluated_version[job_rank] = version;
+        keys[job_rank] = insertions[job_rank].cost;
+        if (keys[job_rank] < std::numeric_limits<double>::max()) {
+          heap.emplace(keys[job_rank], job_rank);
         }
-        keep_going = true;
-
-        unassigned_costs.update_max_edge(input, route);
-        unassigned_costs.update_min_costs(input, unassigned, best_job.index());
-        unassigned_costs
-          .update_min_costs(input,
-                            unassigned,
-                            input.jobs[best_job_rank + 1].index());
+      } else {
+        evaluated_version[job_rank] = 0;
+        keys[job_rank] = std::numeric_limits<double>::max();
+      }
+    }
+
+    if (!found) {
+      break;
+    }
+
+    const auto& best = insertions[best_job_rank];
+    const auto& best_job = input.jobs[best_job_rank];
+    is_candidate[best_job_rank] = false;
+    inserted_ranks.clear();
+
+    if (best_job.type == JOB_TYPE::SINGLE) {
+      route.add(input, best_job_rank, best.r);
+      unassigned.erase(best_job_rank);
+      // Update budget trackers
+      if (input.include_action_time_in_budget()) {
+        const auto d = utils::action_time_delta_single(input,
+                                                      vehicle,
+                                                      route.route,
+                                                      best_job_rank,
+                                                      best.r);
+        route_action_cost += utils::action_cost_from_duration(vehicle, d);
       }
+      inserted_ranks.push_back(best.r);
 
-      route_eval += best_eval;
+      unassigned_costs.update_max_edge(input, route);
+      unassigned_costs.update_min_costs(input, unassigned, best_job.index());
+    }
+    if (best_job.type == JOB_TYPE::PICKUP) {
+      std::vector<Index> modified_with_pd;
+      modified_with_pd.reserve(best.delivery_r - best.pickup_r + 2);
+      modified_with_pd.push_back(best_job_rank);
+
+      std::copy(route.route.begin() + best.pickup_r,
+                route.route.begin() + best.delivery_r,
+                std::back_inserter(modified_with_pd));
+      modified_with_pd.push_back(best_job_rank + 1);
+
+      route.replace(input,
+                    best.modified_delivery,
+                    modified_with_pd.begin(),
+                    modified_with_pd.end(),
+                    best.pickup_r,
+                    best.delivery_r);
+      unassigned.erase(best_job_rank);
+      unassigned.erase(best_job_rank + 1);
+      // Update budget trackers
+      if (input.include_action_time_in_budget()) {
+        const auto d = utils::action_time_delta_pd(input,
+                                                  vehicle,
+                                                  route.route,
+                                                  best_job_rank,
+                                                  best.pickup_r,
+                                                  best.delivery_r);
+        route_action_cost += utils::action_cost_from_duration(vehicle, d);
+      }
+      inserted_ranks.push_back(best.pickup_r);
+      inserted_ranks.push_back(best.delivery_r + 1);
+
+      unassigned_costs.update_max_edge(input, route);
+      unassigned_costs.update_min_costs(input, unassigned, best_job.index());
+      unassigned_costs
+        .update_min_costs(input,
+                          unassigned,
+                          input.jobs[best_job_rank + 1].index());
+    }
+
+    route_eval += best.eval;
+    ++version;
+
+    // Costs at unchanged ranks are unchanged, but their validity may
+    // change either way, so keys for remaining candidates are lowered
+    // based on addition costs at any rank.
+    std::erase(candidates, best_job_rank);
+    bounds.resize(candidates.size());
+    for_each_block(input,
+                   nb_threads,
+                   candidates.size(),
+                   [&](std::size_t begin, std::size_t end) {
+                     for (auto i = begin; i < end; ++i) {
+                       const auto job_rank = candidates[i];
+                       const auto& job = input.jobs[job_rank];
+                       bounds[i] = std::numeric_limits<double>::max();
+                       if (vehicle.max_tasks <
+                           route.size() +
+                             (job.type == JOB_TYPE::PICKUP ? 2 : 1)) {
+                         continue;
+                       }
+
+                       // Only additions next to inserted jobs have new
+                       // costs.
+                       for (const auto r : inserted_ranks) {
+                         update_min_additions(job_rank, r);
+                         update_min_additions(job_rank, r + 1);
+                       }
+                       bounds[i] = get_lower_bound(job_rank);
+                     }
+                   });
+
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+      const auto job_rank = candidates[i];
+      if (bounds[i] < keys[job_rank]) {
+        keys[job_rank] = bounds[i];
+        heap.emplace(bounds[i], job_rank);
+      }
     }
   }
 
@@ -654,7 +922,8 @@ Eval basic(const Input& input,
            std::vector<Index> vehicles_ranks,
            INIT init,
            double lambda,
-           SORT sort) {
+           SORT sort,
+           unsigned nb_threads) {
   // Ordering is based on vehicles description only so do not account
   // for initial routes if any.
   const auto nb_vehicles = vehicles_ranks.size();
@@ -737,7 +1006,7 @@ Eval basic(const Input& input,
     }
 
     const auto current_eval =
-      fill_route(input, current_r, unassigned, regrets[v], lambda);
+      fill_route(input, current_r, unassigned, regrets[v], lambda, nb_threads);
     sol_eval += current_eval;
   }
 
@@ -751,46 +1020,76 @@ Eval dynamic_vehicle_choice(const Input& input,
                             std::vector<Index> vehicles_ranks,
                             INIT init,
                             double lambda,
-                            SORT sort) {
+                            SORT sort,
+                            unsigned nb_threads) {
   const auto& evals = input.jobs_vehicles_evals();
 
   Eval sol_eval;
 
-  while (!vehicles_ranks.empty() && !unassigned.empty()) {
-    // For any unassigned job at j, jobs_min_costs[j]
-    // (resp. jobs_second_min_costs[j]) holds the min cost
-    // (resp. second min cost) of picking the job in an empty route
-    // for any remaining vehicle. Evaluation are based on empty routes
-    // so do not account for initial routes if any.
-    std::vector<Cost> jobs_min_costs(input.jobs.size(),
-                                     input.get_cost_upper_bound());
-    std::vector<Cost> jobs_second_min_costs(input.jobs.size(),
-                                            input.get_cost_upper_bound());
-    for (const auto j : unassigned) {
-      for (const auto v : vehicles_ranks) {
-        if (evals[j][v].cost <= jobs_min_costs[j]) {
-          jobs_second_min_costs[j] = jobs_min_costs[j];
-          jobs_min_costs[j] = evals[j][v].cost;
-        } else {
-          if (evals[j][v].cost < jobs_second_min_costs[j]) {
-            jobs_second_min_costs[j] = evals[j][v].cost;
-          }
+  // For any unassigned job at j, jobs_min_costs[j]
+  // (resp. jobs_second_min_costs[j]) holds the min cost (resp. second
+  // min cost) of picking the job in an empty route for any remaining
+  // vehicle. Evaluation are based on empty routes so do not account
+  // for initial routes if any.
+  std::vector<Cost> jobs_min_costs(input.jobs.size(),
+                                   input.get_cost_upper_bound());
+  std::vector<Cost> jobs_second_min_costs(input.jobs.size(),
+                                          input.get_cost_upper_bound());
+
+  auto update_min_costs = [&](const Index j) {
+    jobs_min_costs[j] = input.get_cost_upper_bound();
+    jobs_second_min_costs[j] = input.get_cost_upper_bound();
+    for (const auto v : vehicles_ranks) {
+      if (evals[j][v].cost <= jobs_min_costs[j]) {
+        jobs_second_min_costs[j] = jobs_min_costs[j];
+        jobs_min_costs[j] = evals[j][v].cost;
+      } else {
+        if (evals[j][v].cost < jobs_second_min_costs[j]) {
+          jobs_second_min_costs[j] = evals[j][v].cost;
         }
       }
     }
+  };
+
+  std::vector<Index> current_unassigned(unassigned.begin(), unassigned.end());
+
+  for_each_block(input,
+                 nb_threads,
+                 current_unassigned.size(),
+                 [&](std::size_t begin, std::size_t end) {
+                   for (auto i = begin; i < end; ++i) {
+                     update_min_costs(current_unassigned[i]);
+                   }
+                 });
+
+  // Number of unassigned jobs closest to each remaining vehicle,
+  // reduced per vehicle so that threads never update the same value.
+  std::vector<unsigned> closest_jobs_count(input.vehicles.size(), 0);
+
+  for_each_block(input,
+                 nb_threads,
+                 vehicles_ranks.size(),
+                 [&](std::size_t begin, std::size_t end) {
+                   for (auto i = begin; i < end; ++i) {
+                     const auto v = vehicles_ranks[i];
+                     for (const auto j : current_unassigned) {
+                       if (evals[j][v].cost == jobs_min_costs[j]) {
+                         ++closest_jobs_count[v];
+                       }
+                     }
+                   }
+                 });
+
+  // Jobs whose min cost may change after filling a route, along with
+  // their previous min cost and whether they're still unassigned.
+  std::vector<Index> changed_jobs;
+  std::vector<Cost> previous_min_costs;
+  std::vector<unsigned char> still_unassigned;
 
+  while (!vehicles_ranks.empty() && !unassigned.empty()) {
     // Pick vehicle that has the biggest number of compatible
     // unassigned jobs closest to him than to any other different
     // vehicle still available.
-    std::vector<unsigned> closest_jobs_count(input.vehicles.size(), 0);
-    for (const auto j : unassigned) {
-      for (const auto v : vehicles_ranks) {
-        if (evals[j][v].cost == jobs_min_costs[j]) {
-          ++closest_jobs_count[v];
-        }
-      }
-    }
-
     Index v_rank;
 
     if (sort == SORT::AVAILABILITY) {
@@ -834,19 +1133,25 @@ Eval dynamic_vehicle_choice(const Input& input,
     // if any.
     std::vector<Cost> regrets(input.jobs.size(), input.get_cost_upper_bound());
 
-    bool all_compatible_jobs_later_undoable = true;
-    for (const auto j : unassigned) {
-      if (jobs_min_costs[j] < evals[j][v_rank].cost) {
-        regrets[j] = jobs_min_costs[j];
-      } else {
-        regrets[j] = jobs_second_min_costs[j];
-      }
-
-      if (input.vehicle_ok_with_job(v_rank, j) &&
-          regrets[j] < input.get_cost_upper_bound()) {
-        all_compatible_jobs_later_undoable = false;
-      }
-    }
+    std::atomic<bool> all_compatible_jobs_later_undoable{true};
+    for_each_block(input,
+                   nb_threads,
+                   current_unassigned.size(),
+                   [&](std::size_t begin, std::size_t end) {
+                     for (auto i = begin; i < end; ++i) {
+                       const auto j = current_unassigned[i];
+                       if (jobs_min_costs[j] < evals[j][v_rank].cost) {
+                         regrets[j] = jobs_min_costs[j];
+                       } else {
+                         regrets[j] = jobs_second_min_costs[j];
+                       }
+
+                       if (input.vehicle_ok_with_job(v_rank, j) &&
+                           regrets[j] < input.get_cost_upper_bound()) {
+                         all_compatible_jobs_later_undoable = false;
+                       }
+                     }
+                   });
 
     if (all_compatible_jobs_later_undoable) {
       // Same approach as for basic heuristic.
@@ -868,8 +1173,55 @@ Eval dynamic_vehicle_choice(const Input& input,
     }
 
     const auto current_eval =
-      fill_route(input, current_r, unassigned, regrets, lambda);
+      fill_route(input, current_r, unassigned, regrets, lambda, nb_threads);
     sol_eval += current_eval;
+
+    // Min costs only change for jobs where current vehicle was one of
+    // the two cheapest, and jobs assigned to current vehicle are no
+    // longer accounted for in counts.
+    changed_jobs.clear();
+    previous_min_costs.clear();
+    still_unassigned.clear();
+    for (const auto j : current_unassigned) {
+      const bool is_unassigned = unassigned.contains(j);
+      if (!is_unassigned ||
+          evals[j][v_rank].cost <= jobs_second_min_costs[j]) {
+        changed_jobs.push_back(j);
+        previous_min_costs.push_back(jobs_min_costs[j]);
+        still_unassigned.push_back(is_unassigned);
+      }
+    }
+    current_unassigned.assign(unassigned.begin(), unassigned.end());
+
+    for_each_block(input,
+                   nb_threads,
+                   changed_jobs.size(),
+                   [&](std::size_t begin, std::size_t end) {
+                     for (auto i = begin; i < end; ++i) {
+                       if (static_cast<bool>(still_unassigned[i])) {
+                         update_min_costs(changed_jobs[i]);
+                       }
+                     }
+                   });
+
+    for_each_block(input,
+                   nb_threads,
+                   vehicles_ranks.size(),
+                   [&](std::size_t begin, std::size_t end) {
+                     for (auto i = begin; i < end; ++i) {
+                       const auto v = vehicles_ranks[i];
+                       for (std::size_t c = 0; c < changed_jobs.size(); ++c) {
+                         const auto j = changed_jobs[c];
+                         if (evals[j][v].cost == previous_min_costs[c]) {
+                           --closest_jobs_count[v];
+                         }
+                         if (static_cast<bool>(still_unassigned[c]) &&
+                             evals[j][v].cost == jobs_min_costs[j]) {
+                           ++closest_jobs_count[v];
+                         }
+                       }
+                     }
+                   });
   }
 
   return sol_eval;
@@ -1059,7 +1411,8 @@ template Eval basic(const Input& input,
                     std::vector<Index> vehicles_ranks,
                     INIT init,
                     double lambda,
-                    SORT sort);
+                    SORT sort,
+                    unsigned nb_threads);
 
 template Eval dynamic_vehicle_choice(const Input& input,
                                      RawSolution& routes,
@@ -1067,7 +1420,8 @@ template Eval dynamic_vehicle_choice(const Input& input,
                                      std::vector<Index> vehicles_ranks,
                                      INIT init,
                                      double lambda,
-                                     SORT sort);
+                                     SORT sort,
+                                     unsigned nb_threads);
 
 template void set_initial_routes(const Input& input,
                                  RawSolution& routes,
@@ -1079,7 +1433,8 @@ template Eval basic(const Input& input,
                     std::vector<Index> vehicles_ranks,
                     INIT init,
                     double lambda,
-                    SORT sort);
+                    SORT sort,
+                    unsigned nb_threads);
 
 template Eval dynamic_vehicle_choice(const Input& input,
                                      TWSolution& routes,
@@ -1087,7 +1442,8 @@ template Eval dynamic_vehicle_choice(const Input& input,
                                      std::vector<Index> vehicles_ranks,
                                      INIT init,
                                      double lambda,
-                                     SORT sort);
+                                     SORT sort,
+                                     unsigned nb_threads);
 
 template void set_initial_routes(const Input& input,
                                  TWSolution& routes,
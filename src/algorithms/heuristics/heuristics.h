@@ -18,7 +18,9 @@ All rights reserved (see LICENSE).
 
 namespace vroom::heuristics {
 
-// Implementation of a variant of the Solomon I1 heuristic.
+// Implementation of a variant of the Solomon I1 heuristic. Up to
+// nb_threads threads from input thread pool are used to scan
+// candidate jobs, without changing the outcome.
 template <class Route>
 Eval basic(const Input& input,
            std::vector<Route>& routes,
@@ -26,7 +28,8 @@ Eval basic(const Input& input,
            std::vector<Index> vehicles_ranks,
            INIT init,
            double lambda,
-           SORT sort);
+           SORT sort,
+           unsigned nb_threads = 1);
 
 // Adjusting the above for situations with heterogeneous fleet.
 template <class Route>
@@ -36,7 +39,8 @@ Eval dynamic_vehicle_choice(const Input& input,
                             std::vector<Index> vehicles_ranks,
                             INIT init,
                             double lambda,
-                            SORT sort);
+                            SORT sort,
+                            unsigned nb_threads = 1);
 
 // Populate routes with user-defined vehicle steps.
 template <class Route>
@@ -138,6 +138,11 @@ RouteInsertion compute_best_insertion_pd(const Input& input,
     return result;
   }
 
+  // Replacement sequence for current insertion, reused across pickup
+  // ranks.
+  std::vector<Index> modified_with_pd;
+  modified_with_pd.reserve(route.size() + 2);
+
   for (Index pickup_r = sol_state.insertion_ranks_begin[v][j];
        pickup_r < sol_state.insertion_ranks_end[v][j];
        ++pickup_r) {
@@ -166,10 +171,7 @@ RouteInsertion compute_best_insertion_pd(const Input& input,
     }
 
     // Build replacement sequence for current insertion.
-    std::vector<Index> modified_with_pd;
-    if (pickup_r <= end_d_rank) {
-      modified_with_pd.reserve(end_d_rank - pickup_r + 2);
-    }
+    modified_with_pd.clear();
     modified_with_pd.push_back(j);
 
     Amount modified_delivery = input.zero_amount();
@@ -12,6 +12,7 @@ All rights reserved (see LICENSE).
 
 #include "algorithms/local_search/insertion_search.h"
 #include "algorithms/local_search/local_search.h"
+#include "algorithms/local_search/move_cache.h"
 #include "problems/vrptw/operators/cross_exchange.h"
 #include "problems/vrptw/operators/intra_cross_exchange.h"
 #include "problems/vrptw/operators/intra_exchange.h"
@@ -32,6 +33,7 @@ All rights reserved (see LICENSE).
 #include "problems/vrptw/operators/two_opt.h"
 #include "problems/vrptw/operators/unassigned_exchange.h"
 #include "utils/helpers.h"
+#include "utils/thread_pool.h"
 
 namespace vroom::ls {
 
@@ -77,12 +79,20 @@ LocalSearch<Route,
             TSPFix>::LocalSearch(const Input& input,
                                  std::vector<Route>& sol,
                                  unsigned depth,
-                                 const Timeout& timeout)
+                                 const Timeout& timeout,
+                                 unsigned nb_threads,
+                                 std::optional<unsigned> completed_depth,
+                                 utils::SolutionRegistry* registry,
+                                 unsigned search_rank)
   : _input(input),
     _nb_vehicles(_input.vehicles.size()),
     _depth(depth),
     _deadline(timeout.has_value() ? utils::now() + timeout.value()
                                   : Deadline()),
+    _nb_threads(nb_threads),
+    _registry(registry),
+    _search_rank(search_rank),
+    _completed_depth(completed_depth),
     _all_routes(_nb_vehicles),
     _sol_state(input),
     _sol(sol),
@@ -118,6 +128,39 @@ RouteInsertion compute_best_insertion(const Input& input,
   return insert;
 }
 
+// Evaluate best move for all source/target pairs, evaluation being
+// spread across threads if a pool is available. Evaluation for a pair
+// has to only read solution data and only update its own PairMove,
+// which is seeded with current best known gain for this pair.
+// Resulting moves are stored in pairs order so outcome does not depend
+// on the number of threads.
+template <class Evaluation>
+void evaluate_pairs(utils::ThreadPool& pool,
+                    unsigned nb_threads,
+                    const std::vector<std::pair<Index, Index>>& s_t_pairs,
+                    MoveCache& best_moves,
+                    const Evaluation& evaluation) {
+  std::vector<PairMove> pair_moves(s_t_pairs.size());
+
+  const auto evaluate = [&](const std::size_t i) {
+    const auto [source, target] = s_t_pairs[i];
+    pair_moves[i].gain = best_moves.gain(source, target);
+    evaluation(source, target, pair_moves[i]);
+  };
+
+  pool.parallel_for(s_t_pairs.size(), evaluate, nb_threads);
+
+  for (std::size_t i = 0; i < s_t_pairs.size(); ++i) {
+    if (pair_moves[i].op != nullptr) {
+      const auto [source, target] = s_t_pairs[i];
+      best_moves.set(source,
+                     target,
+                     pair_moves[i].gain,
+                     std::move(pair_moves[i].op));
+    }
+  }
+}
+
 template <class Route,
           class UnassignedExchange,
           class CrossExchange,
@@ -395,17 +438,11 @@ LocalSearch<Route,
     }
   } while (job_added);
 
-  // Update stored data for consistency (except update_route_eval and
-  // set_insertion_ranks done along the way).
+  // Other stored data is recomputed before looking for moves
+  // (update_route_eval and set_insertion_ranks are done along the
+  // way).
   for (const auto v : modified_vehicles) {
-    _sol_state.update_route_bbox(_sol[v].route, v);
-    _sol_state.update_costs(_sol[v].route, v);
-    _sol_state.update_skills(_sol[v].route, v);
-    _sol_state.update_priorities(_sol[v].route, v);
-    _sol_state.set_node_gains(_sol[v].route, v);
-    _sol_state.set_edge_gains(_sol[v].route, v);
-    _sol_state.set_pd_matching_ranks(_sol[v].route, v);
-    _sol_state.set_pd_gains(_sol[v].route, v);
+    _sol_state.invalidate(v);
   }
 
   return modified_vehicles;
@@ -431,7 +468,7 @@ template <class Route,
           class RouteSplit,
           class PriorityReplace,
           class TSPFix>
-void LocalSearch<Route,
+bool LocalSearch<Route,
                  UnassignedExchange,
                  CrossExchange,
                  MixedExchange,
@@ -451,11 +488,8 @@ void LocalSearch<Route,
                  RouteSplit,
                  PriorityReplace,
                  TSPFix>::run_ls_step() {
-  // Store best move involving a pair of routes.
-  std::vector<std::vector<std::unique_ptr<Operator>>> best_ops(_nb_vehicles);
-  for (std::size_t v = 0; v < _nb_vehicles; ++v) {
-    best_ops[v] = std::vector<std::unique_ptr<Operator>>(_nb_vehicles);
-  }
+  // Store best move and matching gain involving a pair of routes.
+  MoveCache best_moves(_nb_vehicles);
 
   // List of source/target pairs we need to test (all related vehicles
   // at first).
@@ -470,11 +504,6 @@ void LocalSearch<Route,
     }
   }
 
-  // Store best gain for matching move.
-  std::vector<std::vector<Eval>> best_gains(_nb_vehicles,
-                                            std::vector<Eval>(_nb_vehicles,
-                                                              Eval()));
-
   // Store best priority increase and number of assigned tasks for use
   // with operators involving a single route and unassigned jobs
   // (UnassignedExchange and PriorityReplace).
@@ -488,8 +517,19 @@ void LocalSearch<Route,
   auto best_removal = std::numeric_limits<unsigned>::max();
 
   while (best_gain.cost > 0 || best_priority > 0) {
+    // Recompute stored data for routes modified since last lookup.
+    _sol_state.refresh(_sol);
+
+    // In granular mode, only look for moves between routes whose
+    // cost tables are stored from the point of view of each other,
+    // instead of computing range costs on demand for all pairs.
+    std::erase_if(s_t_pairs, [this](const auto& p) {
+      return !_sol_state.has_range_costs(p.first, p.second) ||
+             !_sol_state.has_range_costs(p.second, p.first);
+    });
+
     if (_deadline.has_value() && _deadline.value() < utils::now()) {
-      break;
+      return false;
     }
 
     if (_input.has_jobs()) {
@@ -583,16 +623,17 @@ void LocalSearch<Route,
                 const bool better_if_valid =
                   (best_priorities[source] < priority_gain) ||
                   (best_priorities[source] == priority_gain &&
-                   best_gains[source][source] < r.gain());
+                   best_moves.gain(source, source) < r.gain());
 
                 if (better_if_valid && r.is_valid()) {
                   best_priorities[source] = priority_gain;
                   best_removals[source] = 0;
                   // This may potentially define a negative value as
                   // best gain in case priority_gain is non-zero.
-                  best_gains[source][source] = r.gain();
-                  best_ops[source][source] =
-                    std::make_unique<UnassignedExchange>(r);
+                  best_moves.set(source,
+                                 source,
+                                 r.gain(),
+                                 std::make_unique<UnassignedExchange>(r));
                 }
               }
             }
@@ -687,14 +728,16 @@ void LocalSearch<Route,
               const auto gain = r.gain();
               if (std::tie(best_priorities[source],
                            removal,
-                           best_gains[source][source]) <
+                           best_moves.gain(source, source)) <
                   std::tie(priority_gain, best_removals[source], gain)) {
                 best_priorities[source] = priority_gain;
                 best_removals[source] = removal;
                 // This may potentially define a negative value as best
                 // gain.
-                best_gains[source][source] = r.gain();
-                best_ops[source][source] = std::make_unique<PriorityReplace>(r);
+                best_moves.set(source,
+                               source,
+                               r.gain(),
+                               std::make_unique<PriorityReplace>(r));
               }
             }
           }
@@ -703,7 +746,9 @@ void LocalSearch<Route,
     }
 
     // CrossExchange stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_cross_exchange = [&](const Index source,
+                                         const Index target,
+                                         PairMove& best) {
       if (target <= source || // This operator is symmetric.
           best_priorities[source] > 0 || best_priorities[target] > 0 ||
           _sol[source].size() < 2 || _sol[target].size() < 2 ||
@@ -711,7 +756,7 @@ void LocalSearch<Route,
            _input.vehicles[source].has_same_profile(_input.vehicles[target]) &&
            !_sol_state.route_bbox[source].intersects(
              _sol_state.route_bbox[target]))) {
-        continue;
+        return;
       }
 
       const auto& s_delivery_margin = _sol[source].delivery_margin();
@@ -817,6 +862,23 @@ void LocalSearch<Route,
             continue;
           }
 
+          if (!utils::is_granular_placement(_input,
+                                            target,
+                                            _sol[target].route,
+                                            t_rank,
+                                            t_rank + 2,
+                                            s_job_rank,
+                                            s_next_job_rank) &&
+              !utils::is_granular_placement(_input,
+                                            source,
+                                            _sol[source].route,
+                                            s_rank,
+                                            s_rank + 2,
+                                            t_job_rank,
+                                            t_next_job_rank)) {
+            continue;
+          }
+
           CrossExchange r(_input,
                           _sol_state,
                           _sol[source],
@@ -828,19 +890,26 @@ void LocalSearch<Route,
                           !is_s_pickup,
                           !is_t_pickup);
 
-          auto& current_best = best_gains[source][target];
+          auto& current_best = best.gain;
           if (current_best < r.gain_upper_bound() && r.is_valid() &&
               current_best < r.gain()) {
             current_best = r.gain();
-            best_ops[source][target] = std::make_unique<CrossExchange>(r);
+            best.op = std::make_unique<CrossExchange>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_cross_exchange);
 
     if (_input.has_jobs()) {
       // MixedExchange stuff
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_mixed_exchange = [&](const Index source,
+                                           const Index target,
+                                           PairMove& best) {
         if (source == target || best_priorities[source] > 0 ||
             best_priorities[target] > 0 || _sol[source].size() == 0 ||
             _sol[target].size() < 2 ||
@@ -849,11 +918,11 @@ void LocalSearch<Route,
                _input.vehicles[target]) &&
              !_sol_state.route_bbox[source].intersects(
                _sol_state.route_bbox[target]))) {
-          continue;
+          return;
         }
 
         if (_sol[source].size() + 1 > _input.vehicles[source].max_tasks) {
-          continue;
+          return;
         }
 
         const auto& s_delivery_margin = _sol[source].delivery_margin();
@@ -941,26 +1010,33 @@ void LocalSearch<Route,
                             t_rank,
                             !is_t_pickup);
 
-            auto& current_best = best_gains[source][target];
+            auto& current_best = best.gain;
             if (current_best < r.gain_upper_bound() && r.is_valid() &&
                 current_best < r.gain()) {
               current_best = r.gain();
-              best_ops[source][target] = std::make_unique<MixedExchange>(r);
+              best.op = std::make_unique<MixedExchange>(std::move(r));
             }
           }
         }
-      }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_mixed_exchange);
     }
 
     // TwoOpt stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_two_opt = [&](const Index source,
+                                  const Index target,
+                                  PairMove& best) {
       if (target <= source || // This operator is symmetric.
           best_priorities[source] > 0 || best_priorities[target] > 0 ||
           (_input.all_locations_have_coords() &&
            _input.vehicles[source].has_same_profile(_input.vehicles[target]) &&
            !_sol_state.route_bbox[source].intersects(
              _sol_state.route_bbox[target]))) {
-        continue;
+        return;
       }
 
       const auto& s_v = _input.vehicles[source];
@@ -1042,6 +1118,20 @@ void LocalSearch<Route,
             continue;
           }
 
+          if (_input.granular_jobs_k() > 0 &&
+              s_rank + 1 < _sol[source].size() &&
+              t_rank + 1 < static_cast<int>(_sol[target].size()) &&
+              !_input.is_granular_arc(source,
+                                      _sol[source].route[s_rank],
+                                      _sol[target].route[t_rank + 1]) &&
+              !_input.is_granular_arc(target,
+                                      _sol[target].route[t_rank],
+                                      _sol[source].route[s_rank + 1])) {
+            // None of the new arcs joining both routes is between
+            // granular neighbours.
+            continue;
+          }
+
           TwoOpt r(_input,
                    _sol_state,
                    _sol[source],
@@ -1051,23 +1141,30 @@ void LocalSearch<Route,
                    target,
                    t_rank);
 
-          if (best_gains[source][target] < r.gain() && r.is_valid()) {
-            best_gains[source][target] = r.gain();
-            best_ops[source][target] = std::make_unique<TwoOpt>(r);
+          if (best.gain < r.gain() && r.is_valid()) {
+            best.gain = r.gain();
+            best.op = std::make_unique<TwoOpt>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_two_opt);
 
     // ReverseTwoOpt stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_reverse_two_opt = [&](const Index source,
+                                          const Index target,
+                                          PairMove& best) {
       if (source == target || best_priorities[source] > 0 ||
           best_priorities[target] > 0 ||
           (_input.all_locations_have_coords() &&
            _input.vehicles[source].has_same_profile(_input.vehicles[target]) &&
            !_sol_state.route_bbox[source].intersects(
              _sol_state.route_bbox[target]))) {
-        continue;
+        return;
       }
 
       const auto& s_v = _input.vehicles[source];
@@ -1151,34 +1248,40 @@ void LocalSearch<Route,
                           target,
                           t_rank);
 
-          if (best_gains[source][target] < r.gain() && r.is_valid()) {
-            best_gains[source][target] = r.gain();
-            best_ops[source][target] = std::make_unique<ReverseTwoOpt>(r);
+          if (best.gain < r.gain() && r.is_valid()) {
+            best.gain = r.gain();
+            best.op = std::make_unique<ReverseTwoOpt>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_reverse_two_opt);
 
     if (_input.has_jobs()) {
       // Move(s) that don't make sense for shipment-only instances.
 
       // Relocate stuff
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_relocate = [&](const Index source,
+                                     const Index target,
+                                     PairMove& best) {
         if (source == target || best_priorities[source] > 0 ||
             best_priorities[target] > 0 || _sol[source].size() == 0) {
-          continue;
+          return;
         }
 
         if (_sol[target].size() + 1 > _input.vehicles[target].max_tasks) {
-          continue;
+          return;
         }
 
         const auto& t_delivery_margin = _sol[target].delivery_margin();
         const auto& t_pickup_margin = _sol[target].pickup_margin();
 
         for (unsigned s_rank = 0; s_rank < _sol[source].size(); ++s_rank) {
-          if (_sol_state.node_gains[source][s_rank] <=
-              best_gains[source][target]) {
+          if (_sol_state.node_gains[source][s_rank] <= best.gain) {
             // Except if addition cost in target route is negative
             // (!!), overall gain can't exceed current known best
             // gain.
@@ -1205,6 +1308,16 @@ void LocalSearch<Route,
                  _sol_state.insertion_ranks_begin[target][s_job_rank];
                t_rank < _sol_state.insertion_ranks_end[target][s_job_rank];
                ++t_rank) {
+            if (!utils::is_granular_placement(_input,
+                                              target,
+                                              _sol[target].route,
+                                              t_rank,
+                                              t_rank,
+                                              s_job_rank,
+                                              s_job_rank)) {
+              continue;
+            }
+
             Relocate r(_input,
                        _sol_state,
                        _sol[source],
@@ -1214,31 +1327,37 @@ void LocalSearch<Route,
                        target,
                        t_rank);
 
-            if (best_gains[source][target] < r.gain() && r.is_valid()) {
-              best_gains[source][target] = r.gain();
-              best_ops[source][target] = std::make_unique<Relocate>(r);
+            if (best.gain < r.gain() && r.is_valid()) {
+              best.gain = r.gain();
+              best.op = std::make_unique<Relocate>(std::move(r));
             }
           }
         }
-      }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_relocate);
 
       // OrOpt stuff
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_or_opt = [&](const Index source,
+                                   const Index target,
+                                   PairMove& best) {
         if (source == target || best_priorities[source] > 0 ||
             best_priorities[target] > 0 || _sol[source].size() < 2) {
-          continue;
+          return;
         }
 
         if (_sol[target].size() + 2 > _input.vehicles[target].max_tasks) {
-          continue;
+          return;
         }
 
         const auto& t_delivery_margin = _sol[target].delivery_margin();
         const auto& t_pickup_margin = _sol[target].pickup_margin();
 
         for (unsigned s_rank = 0; s_rank < _sol[source].size() - 1; ++s_rank) {
-          if (_sol_state.edge_gains[source][s_rank] <=
-              best_gains[source][target]) {
+          if (_sol_state.edge_gains[source][s_rank] <= best.gain) {
             // Except if addition cost in route target is negative
             // (!!), overall gain can't exceed current known best gain.
             continue;
@@ -1278,6 +1397,16 @@ void LocalSearch<Route,
                      _sol_state.insertion_ranks_end[target][s_next_job_rank]);
           for (unsigned t_rank = insertion_start; t_rank < insertion_end;
                ++t_rank) {
+            if (!utils::is_granular_placement(_input,
+                                              target,
+                                              _sol[target].route,
+                                              t_rank,
+                                              t_rank,
+                                              s_job_rank,
+                                              s_next_job_rank)) {
+              continue;
+            }
+
             OrOpt r(_input,
                     _sol_state,
                     _sol[source],
@@ -1287,39 +1416,53 @@ void LocalSearch<Route,
                     target,
                     t_rank);
 
-            auto& current_best = best_gains[source][target];
+            auto& current_best = best.gain;
             if (current_best < r.gain_upper_bound() && r.is_valid() &&
                 current_best < r.gain()) {
               current_best = r.gain();
-              best_ops[source][target] = std::make_unique<OrOpt>(r);
+              best.op = std::make_unique<OrOpt>(std::move(r));
             }
           }
         }
-      }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_or_opt);
     }
 
     // TSPFix stuff
     if (_input.apply_TSPFix() && !_input.has_shipments()) {
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_tsp_fix = [&](const Index source,
+                                    const Index target,
+                                    PairMove& best) {
         if (target != source || best_priorities[source] > 0 ||
             _sol[source].size() < 2) {
-          continue;
+          return;
         }
 
         TSPFix op(_input, _sol_state, _sol[source], source);
 
-        if (best_gains[source][target] < op.gain() && op.is_valid()) {
-          best_gains[source][target] = op.gain();
-          best_ops[source][target] = std::make_unique<TSPFix>(op);
+        if (best.gain < op.gain() && op.is_valid()) {
+          best.gain = op.gain();
+          best.op = std::make_unique<TSPFix>(std::move(op));
         }
-      }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_tsp_fix);
     }
 
     // IntraExchange stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_intra_exchange = [&](const Index source,
+                                         const Index target,
+                                         PairMove& best) {
       if (source != target || best_priorities[source] > 0 ||
           _sol[source].size() < 3) {
-        continue;
+        return;
       }
 
       for (unsigned s_rank = 0; s_rank < _sol[source].size() - 2; ++s_rank) {
@@ -1357,20 +1500,27 @@ void LocalSearch<Route,
                           s_rank,
                           t_rank);
 
-          if (best_gains[source][source] < r.gain() && r.is_valid()) {
-            best_gains[source][source] = r.gain();
-            best_ops[source][source] = std::make_unique<IntraExchange>(r);
+          if (best.gain < r.gain() && r.is_valid()) {
+            best.gain = r.gain();
+            best.op = std::make_unique<IntraExchange>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_intra_exchange);
 
     // IntraCrossExchange stuff
     constexpr unsigned min_intra_cross_exchange_size = 5;
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_intra_cross_exchange = [&](const Index source,
+                                               const Index target,
+                                               PairMove& best) {
       if (source != target || best_priorities[source] > 0 ||
           _sol[source].size() < min_intra_cross_exchange_size) {
-        continue;
+        return;
       }
 
       for (unsigned s_rank = 0; s_rank <= _sol[source].size() - 4; ++s_rank) {
@@ -1426,21 +1576,28 @@ void LocalSearch<Route,
                                !is_s_pickup,
                                !is_t_pickup);
 
-          auto& current_best = best_gains[source][target];
+          auto& current_best = best.gain;
           if (current_best < r.gain_upper_bound() && r.is_valid() &&
               current_best < r.gain()) {
             current_best = r.gain();
-            best_ops[source][source] = std::make_unique<IntraCrossExchange>(r);
+            best.op = std::make_unique<IntraCrossExchange>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_intra_cross_exchange);
 
     // IntraMixedExchange stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_intra_mixed_exchange = [&](const Index source,
+                                               const Index target,
+                                               PairMove& best) {
       if (source != target || best_priorities[source] > 0 ||
           _sol[source].size() < 4) {
-        continue;
+        return;
       }
 
       for (unsigned s_rank = 0; s_rank < _sol[source].size(); ++s_rank) {
@@ -1493,26 +1650,32 @@ void LocalSearch<Route,
                                s_rank,
                                t_rank,
                                !is_t_pickup);
-          auto& current_best = best_gains[source][target];
+          auto& current_best = best.gain;
           if (current_best < r.gain_upper_bound() && r.is_valid() &&
               current_best < r.gain()) {
             current_best = r.gain();
-            best_ops[source][source] = std::make_unique<IntraMixedExchange>(r);
+            best.op = std::make_unique<IntraMixedExchange>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_intra_mixed_exchange);
 
     // IntraRelocate stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_intra_relocate = [&](const Index source,
+                                         const Index target,
+                                         PairMove& best) {
       if (source != target || best_priorities[source] > 0 ||
           _sol[source].size() < 2) {
-        continue;
+        return;
       }
 
       for (unsigned s_rank = 0; s_rank < _sol[source].size(); ++s_rank) {
-        if (_sol_state.node_gains[source][s_rank] <=
-            best_gains[source][source]) {
+        if (_sol_state.node_gains[source][s_rank] <= best.gain) {
           // Except if addition cost in route is negative (!!),
           // overall gain can't exceed current known best gain.
           continue;
@@ -1553,19 +1716,26 @@ void LocalSearch<Route,
                           s_rank,
                           t_rank);
 
-          if (best_gains[source][source] < r.gain() && r.is_valid()) {
-            best_gains[source][source] = r.gain();
-            best_ops[source][source] = std::make_unique<IntraRelocate>(r);
+          if (best.gain < r.gain() && r.is_valid()) {
+            best.gain = r.gain();
+            best.op = std::make_unique<IntraRelocate>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_intra_relocate);
 
     // IntraOrOpt stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_intra_or_opt = [&](const Index source,
+                                       const Index target,
+                                       PairMove& best) {
       if (source != target || best_priorities[source] > 0 ||
           _sol[source].size() < 4) {
-        continue;
+        return;
       }
       for (unsigned s_rank = 0; s_rank < _sol[source].size() - 1; ++s_rank) {
         const auto& job_type = _input.jobs[_sol[source].route[s_rank]].type;
@@ -1584,16 +1754,14 @@ void LocalSearch<Route,
         }
 
         if (is_pickup) {
-          if (_sol_state.pd_gains[source][s_rank] <=
-              best_gains[source][source]) {
+          if (_sol_state.pd_gains[source][s_rank] <= best.gain) {
             // Except if addition cost in route is negative (!!),
             // overall gain can't exceed current known best gain.
             continue;
           }
         } else {
           // Regular single job.
-          if (_sol_state.edge_gains[source][s_rank] <=
-              best_gains[source][source]) {
+          if (_sol_state.edge_gains[source][s_rank] <= best.gain) {
             // Except if addition cost in route is negative (!!),
             // overall gain can't exceed current known best gain.
             continue;
@@ -1625,21 +1793,28 @@ void LocalSearch<Route,
                        s_rank,
                        t_rank,
                        !is_pickup);
-          auto& current_best = best_gains[source][target];
+          auto& current_best = best.gain;
           if (current_best < r.gain_upper_bound() && r.is_valid() &&
               current_best < r.gain()) {
             current_best = r.gain();
-            best_ops[source][source] = std::make_unique<IntraOrOpt>(r);
+            best.op = std::make_unique<IntraOrOpt>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_intra_or_opt);
 
     // IntraTwoOpt stuff
-    for (const auto& [source, target] : s_t_pairs) {
+    const auto eval_intra_two_opt = [&](const Index source,
+                                        const Index target,
+                                        PairMove& best) {
       if (source != target || best_priorities[source] > 0 ||
           _sol[source].size() < 4) {
-        continue;
+        return;
       }
       for (unsigned s_rank = 0; s_rank < _sol[source].size() - 2; ++s_rank) {
         const auto s_job_rank = _sol[source].route[s_rank];
@@ -1656,28 +1831,35 @@ void LocalSearch<Route,
                         source,
                         s_rank,
                         t_rank);
-          auto& current_best = best_gains[source][target];
+          auto& current_best = best.gain;
           if (current_best < r.gain() && r.is_valid()) {
             current_best = r.gain();
-            best_ops[source][source] = std::make_unique<IntraTwoOpt>(r);
+            best.op = std::make_unique<IntraTwoOpt>(std::move(r));
           }
         }
       }
-    }
+    };
+    evaluate_pairs(_input.thread_pool(),
+                   _nb_threads,
+                   s_t_pairs,
+                   best_moves,
+                   eval_intra_two_opt);
 
     if (_input.has_shipments()) {
       // Move(s) that don't make sense for job-only instances.
 
       // PDShift stuff
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_pd_shift = [&](const Index source,
+                                     const Index target,
+                                     PairMove& best) {
         if (source == target || best_priorities[source] > 0 ||
             best_priorities[target] > 0 || _sol[source].size() == 0) {
           // Don't try to put things from an empty vehicle.
-          continue;
+          return;
         }
 
         if (_sol[target].size() + 2 > _input.vehicles[target].max_tasks) {
-          continue;
+          return;
         }
 
         for (unsigned s_p_rank = 0; s_p_rank < _sol[source].size();
@@ -1698,8 +1880,7 @@ void LocalSearch<Route,
             continue;
           }
 
-          if (_sol_state.pd_gains[source][s_p_rank] <=
-              best_gains[source][target]) {
+          if (_sol_state.pd_gains[source][s_p_rank] <= best.gain) {
             // Except if addition cost in target route is negative
             // (!!), overall gain can't exceed current known best
             // gain.
@@ -1722,20 +1903,27 @@ void LocalSearch<Route,
                       s_d_rank,
                       _sol[target],
                       target,
-                      best_gains[source][target]);
+                      best.gain);
 
-          if (best_gains[source][target] < pdr.gain() && pdr.is_valid()) {
-            best_gains[source][target] = pdr.gain();
-            best_ops[source][target] = std::make_unique<PDShift>(pdr);
+          if (best.gain < pdr.gain() && pdr.is_valid()) {
+            best.gain = pdr.gain();
+            best.op = std::make_unique<PDShift>(std::move(pdr));
           }
         }
-      }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_pd_shift);
     }
 
     if (!_input.has_homogeneous_locations() ||
         !_input.has_homogeneous_profiles() || !_input.has_homogeneous_costs()) {
       // RouteExchange stuff
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_route_exchange = [&](const Index source,
+                                           const Index target,
+                                           PairMove& best) {
         if (target <= source || best_priorities[source] > 0 ||
             best_priorities[target] > 0 ||
             (_sol[source].size() == 0 && _sol[target].size() == 0) ||
@@ -1743,7 +1931,7 @@ void LocalSearch<Route,
             _sol_state.bwd_skill_rank[target][source] > 0) {
           // Different routes (and operator is symmetric), at least
           // one non-empty and valid wrt vehicle/job compatibility.
-          continue;
+          return;
         }
 
         const auto& s_v = _input.vehicles[source];
@@ -1751,7 +1939,7 @@ void LocalSearch<Route,
 
         if (_sol[source].size() > t_v.max_tasks ||
             _sol[target].size() > s_v.max_tasks) {
-          continue;
+          return;
         }
 
         const auto& s_deliveries_sum = _sol[source].job_deliveries_sum();
@@ -1763,7 +1951,7 @@ void LocalSearch<Route,
             !(t_pickups_sum <= s_v.capacity) ||
             !(s_deliveries_sum <= t_v.capacity) ||
             !(s_pickups_sum <= t_v.capacity)) {
-          continue;
+          return;
         }
 
         RouteExchange re(_input,
@@ -1773,16 +1961,23 @@ void LocalSearch<Route,
                          _sol[target],
                          target);
 
-        if (best_gains[source][target] < re.gain() && re.is_valid()) {
-          best_gains[source][target] = re.gain();
-          best_ops[source][target] = std::make_unique<RouteExchange>(re);
+        if (best.gain < re.gain() && re.is_valid()) {
+          best.gain = re.gain();
+          best.op = std::make_unique<RouteExchange>(std::move(re));
         }
-      }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_route_exchange);
     }
 
     if (_input.has_jobs()) {
       // SwapStar stuff
-      for (const auto& [source, target] : s_t_pairs) {
+      const auto eval_swap_star = [&](const Index source,
+                                      const Index target,
+                                      PairMove& best) {
         if (target <= source || // This operator is symmetric.
             best_priorities[source] > 0 || best_priorities[target] > 0 ||
             _sol[source].size() == 0 || _sol[target].size() == 0 ||
@@ -1792,7 +1987,7 @@ void LocalSearch<Route,
                _input.vehicles[target]) &&
              !_sol_state.route_bbox[source].intersects(
                _sol_state.route_bbox[target]))) {
-          continue;
+          return;
         }
 
         SwapStar r(_input,
@@ -1801,13 +1996,18 @@ void LocalSearch<Route,
                    source,
                    _sol[target],
                    target,
-                   best_gains[source][target]);
-
-        if (best_gains[source][target] < r.gain()) {
-          best_gains[source][target] = r.gain();
-          best_ops[source][target] = std::make_unique<SwapStar>(r);
-        }
-      }
+                   best.gain);
+
+        if (best.gain < r.gain()) {
+          best.gain = r.gain();
+          best.op = std::make_unique<SwapStar>(std::move(r));
+        }
+      };
+      evaluate_pairs(_input.thread_pool(),
+                     _nb_threads,
+                     s_t_pairs,
+                     best_moves,
+                     eval_swap_star);
     }
 
     if (!_input.has_homogeneous_locations() ||
@@ -1823,10 +2023,12 @@ void LocalSearch<Route,
       }
 
       if (empty_route_ranks.size() >= 2) {
-        for (const auto& [source, target] : s_t_pairs) {
+        const auto eval_route_split = [&](const Index source,
+                                          const Index target,
+                                          PairMove& best) {
           if (target != source || best_priorities[source] > 0 ||
               _sol[source].size() < 2) {
-            continue;
+            return;
           }
 
           // RouteSplit stores a const& to empty_route_ranks, which
@@ -1840,13 +2042,18 @@ void LocalSearch<Route,
                        source,
                        empty_route_ranks,
                        _sol,
-                       best_gains[source][target]);
-
-          if (best_gains[source][target] < r.gain()) {
-            best_gains[source][target] = r.gain();
-            best_ops[source][target] = std::make_unique<RouteSplit>(r);
-          }
-        }
+                       best.gain);
+
+          if (best.gain < r.gain()) {
+            best.gain = r.gain();
+            best.op = std::make_unique<RouteSplit>(std::move(r));
+          }
+        };
+        evaluate_pairs(_input.thread_pool(),
+                       _nb_threads,
+                       s_t_pairs,
+                       best_moves,
+                       eval_route_split);
       }
     }
 
@@ -1859,36 +2066,36 @@ void LocalSearch<Route,
     Index best_target = 0;
 
     for (unsigned s_v = 0; s_v < _nb_vehicles; ++s_v) {
+      const auto& s_v_gain = best_moves.gain(s_v, s_v);
       if (std::tie(best_priority, best_removals[s_v], best_gain) <
-          std::tie(best_priorities[s_v], best_removal, best_gains[s_v][s_v])) {
+          std::tie(best_priorities[s_v], best_removal, s_v_gain)) {
         best_priority = best_priorities[s_v];
         best_removal = best_removals[s_v];
-        best_gain = best_gains[s_v][s_v];
+        best_gain = s_v_gain;
         best_source = s_v;
         best_target = s_v;
       }
     }
 
     if (best_priority == 0) {
-      for (unsigned s_v = 0; s_v < _nb_vehicles; ++s_v) {
-        for (unsigned t_v = 0; t_v < _nb_vehicles; ++t_v) {
-          if (best_gain < best_gains[s_v][t_v]) {
-            best_gain = best_gains[s_v][t_v];
-            best_source = s_v;
-            best_target = t_v;
-          }
-        }
+      // Same outcome as scanning all pairs in order and only keeping
+      // strictly better gains.
+      if (const auto best_move = best_moves.best();
+          best_move.has_value() && best_gain < best_move->gain) {
+        best_gain = best_move->gain;
+        best_source = best_move->source;
+        best_target = best_move->target;
       }
     }
 
     // Apply matching operator.
     if (best_priority > 0 || best_gain.cost > 0) {
-      assert(best_ops[best_source][best_target] != nullptr);
+      auto* const best_op = best_moves.op(best_source, best_target);
+      assert(best_op != nullptr);
 
-      best_ops[best_source][best_target]->apply();
+      best_op->apply();
 
-      auto update_candidates =
-        best_ops[best_source][best_target]->update_candidates();
+      auto update_candidates = best_op->update_candidates();
 
 #ifndef NDEBUG
       // Update route costs.
@@ -1902,16 +2109,11 @@ void LocalSearch<Route,
 #endif
 
       for (auto v_rank : update_candidates) {
+        // Required right away for job additions, other data is
+        // recomputed before next lookup.
         _sol_state.update_route_eval(_sol[v_rank].route, v_rank);
-        _sol_state.update_route_bbox(_sol[v_rank].route, v_rank);
-        _sol_state.update_costs(_sol[v_rank].route, v_rank);
-        _sol_state.update_skills(_sol[v_rank].route, v_rank);
-        _sol_state.update_priorities(_sol[v_rank].route, v_rank);
         _sol_state.set_insertion_ranks(_sol[v_rank], v_rank);
-        _sol_state.set_node_gains(_sol[v_rank].route, v_rank);
-        _sol_state.set_edge_gains(_sol[v_rank].route, v_rank);
-        _sol_state.set_pd_matching_ranks(_sol[v_rank].route, v_rank);
-        _sol_state.set_pd_gains(_sol[v_rank].route, v_rank);
+        _sol_state.invalidate(v_rank);
 
         assert(_sol[v_rank].size() <= _input.vehicles[v_rank].max_tasks);
         assert(_input.vehicles[v_rank].ok_for_range_bounds(
@@ -1930,9 +2132,7 @@ void LocalSearch<Route,
 #endif
 
       auto modified_vehicles =
-        try_job_additions(best_ops[best_source][best_target]
-                            ->addition_candidates(),
-                          0);
+        try_job_additions(best_op->addition_candidates(), 0);
 
       // Extend update_candidates in case a vehicle was not modified
       // by the operator itself but afterward by
@@ -1944,21 +2144,19 @@ void LocalSearch<Route,
         update_candidates.push_back(v);
       }
 
-      // Set gains to zero for what needs to be recomputed in the next
+      // Drop stored moves for what needs to be recomputed in the next
       // round and set route pairs accordingly.
       s_t_pairs.clear();
       for (auto v_rank : update_candidates) {
-        best_gains[v_rank].assign(_nb_vehicles, Eval());
+        best_moves.erase_source(v_rank);
         best_priorities[v_rank] = 0;
         best_removals[v_rank] = std::numeric_limits<unsigned>::max();
-        best_ops[v_rank] = std::vector<std::unique_ptr<Operator>>(_nb_vehicles);
       }
 
       for (unsigned v = 0; v < _nb_vehicles; ++v) {
         for (auto v_rank : update_candidates) {
           if (_input.vehicle_ok_with_vehicle(v, v_rank)) {
-            best_gains[v][v_rank] = Eval();
-            best_ops[v][v_rank] = std::unique_ptr<Operator>();
+            best_moves.erase(v, v_rank);
 
             s_t_pairs.emplace_back(v, v_rank);
             if (v != v_rank) {
@@ -1969,13 +2167,14 @@ void LocalSearch<Route,
       }
 
       for (unsigned v = 0; v < _nb_vehicles; ++v) {
-        if (best_ops[v][v] == nullptr) {
+        const auto* const v_op = best_moves.op(v, v);
+        if (v_op == nullptr) {
           continue;
         }
 
         bool invalidate_move = false;
 
-        for (auto req_u : best_ops[v][v]->required_unassigned()) {
+        for (auto req_u : v_op->required_unassigned()) {
           if (!_sol_state.unassigned.contains(req_u)) {
             // This move should be invalidated because a required
             // unassigned job has been added by try_job_additions in
@@ -1986,20 +2185,26 @@ void LocalSearch<Route,
         }
 
         for (auto v_rank : update_candidates) {
-          invalidate_move =
-            invalidate_move || best_ops[v][v]->invalidated_by(v_rank);
+          invalidate_move = invalidate_move || v_op->invalidated_by(v_rank);
         }
 
         if (invalidate_move) {
-          best_gains[v][v] = Eval();
+          best_moves.erase(v, v);
           best_priorities[v] = 0;
           best_removals[v] = std::numeric_limits<unsigned>::max();
-          best_ops[v][v] = std::unique_ptr<Operator>();
           s_t_pairs.emplace_back(v, v);
         }
       }
+
+      // Pairs may have been added several times above while each
+      // pair is required exactly once for evaluation.
+      std::ranges::sort(s_t_pairs);
+      const auto duplicates = std::ranges::unique(s_t_pairs);
+      s_t_pairs.erase(duplicates.begin(), duplicates.end());
     }
   }
+
+  return true;
 }
 
 template <class Route,
@@ -2042,11 +2247,54 @@ void LocalSearch<Route,
                  RouteSplit,
                  PriorityReplace,
                  TSPFix>::run() {
-  bool try_ls_step = true;
+  while (true) {
+    if (_completed_depth.has_value()) {
+      // Try again on each improvement until we reach last job
+      // removal level or deadline is met. This is also where a run
+      // resumes after stopping on its deadline.
+      const auto nb_removal = _completed_depth.value() + 1;
+      if (nb_removal > _depth ||
+          (_deadline.has_value() && _deadline.value() <= utils::now())) {
+        break;
+      }
+
+      // Get a looser situation by removing jobs.
+      std::unordered_set<Index> modified_vehicles;
+      for (unsigned i = 0; i < nb_removal; ++i) {
+        for (const auto v : remove_from_routes()) {
+          // Update what is required for consistency in
+          // remove_from_routes.
+          _sol_state.update_route_eval(_sol[v].route, v);
+          _sol_state.set_node_gains(_sol[v].route, v);
+          _sol_state.set_pd_matching_ranks(_sol[v].route, v);
+          _sol_state.set_pd_gains(_sol[v].route, v);
+          _sol_state.invalidate(v);
+          modified_vehicles.insert(v);
+        }
+      }
+
+      // Required for job additions, other data is recomputed before
+      // looking for moves.
+      for (const auto v : modified_vehicles) {
+        _sol_state.set_insertion_ranks(_sol[v], v);
+      }
+
+      // Refill jobs.
+      constexpr double refill_regret = 1.5;
+      try_job_additions(_all_routes, refill_regret);
+    }
 
-  while (try_ls_step) {
     // A round of local search.
-    run_ls_step();
+    const bool step_completed = run_ls_step();
+
+    // Exploring from a solution another search already reached would
+    // be duplicate work. Steps interrupted by deadline do not end on
+    // a local optimum so they are not registered.
+    const bool already_explored =
+      step_completed && _registry != nullptr &&
+      _registry->found_by_other_search(utils::get_solution_fingerprint(_sol),
+                                       _search_rank,
+                                       _nb_steps++);
 
     // Comparison with indicators for current solution.
     if (const utils::SolutionIndicators current_sol_indicators(_input, _sol);
@@ -2057,61 +2305,101 @@ void LocalSearch<Route,
       // No improvement so back to previous best known for further
       // steps.
       if (_best_sol_indicators < current_sol_indicators) {
+        // Stored data is only recomputed for routes that differ from
+        // previous best known.
+        std::vector<Index> modified_vehicles;
+        for (std::size_t v = 0; v < _sol.size(); ++v) {
+          if (_sol[v].route != _best_sol[v].route) {
+            modified_vehicles.push_back(v);
+            for (const auto j : _sol[v].route) {
+              _sol_state.unassigned.insert(j);
+            }
+          }
+        }
+
         _sol = _best_sol;
-        _sol_state.setup(_sol);
+
+        for (const auto v : modified_vehicles) {
+          for (const auto j : _sol[v].route) {
+            _sol_state.unassigned.erase(j);
+          }
+          _sol_state.update_route_eval(_sol[v].route, v);
+          _sol_state.set_insertion_ranks(_sol[v], v);
+          _sol_state.invalidate(v);
+        }
+        _sol_state.refresh(_sol);
       }
 
-      if (_completed_depth.has_value()) {
+      if (_completed_depth.has_value() && step_completed) {
         // Rule out situation with first descent not yielding a better
         // solution.
         ++_completed_depth.value();
       }
     }
 
+    if (!step_completed) {
+      // Stopped on deadline: removal level is explored again (or
+      // first descent goes on) upon resuming.
+      break;
+    }
+
     if (!_completed_depth.has_value()) {
       // End of first descent.
       _completed_depth = 0;
     }
 
-    // Try again on each improvement until we reach last job removal
-    // level or deadline is met.
-    assert(_completed_depth.has_value());
-    auto nb_removal = _completed_depth.value() + 1;
-    try_ls_step = (nb_removal <= _depth) &&
-                  (!_deadline.has_value() || utils::now() < _deadline.value());
-
-    if (try_ls_step) {
-      // Get a looser situation by removing jobs.
-      for (unsigned i = 0; i < nb_removal; ++i) {
-        remove_from_routes();
-        for (std::size_t v = 0; v < _sol.size(); ++v) {
-          // Update what is required for consistency in
-          // remove_from_route.
-          _sol_state.update_route_eval(_sol[v].route, v);
-          _sol_state.update_route_bbox(_sol[v].route, v);
-          _sol_state.set_node_gains(_sol[v].route, v);
-          _sol_state.set_pd_matching_ranks(_sol[v].route, v);
-          _sol_state.set_pd_gains(_sol[v].route, v);
-        }
-      }
-
-      // Update stored data that has not been maintained while
-      // removing.
-      for (std::size_t v = 0; v < _sol.size(); ++v) {
-        _sol_state.update_costs(_sol[v].route, v);
-        _sol_state.update_skills(_sol[v].route, v);
-        _sol_state.update_priorities(_sol[v].route, v);
-        _sol_state.set_insertion_ranks(_sol[v], v);
-        _sol_state.set_edge_gains(_sol[v].route, v);
-      }
-
-      // Refill jobs.
-      constexpr double refill_regret = 1.5;
-      try_job_additions(_all_routes, refill_regret);
+    if (already_explored) {
+      // The other search explores further from there.
+      _completed_depth = _depth;
+      break;
     }
   }
 }
 
+template <class Route,
+          class UnassignedExchange,
+          class CrossExchange,
+          class MixedExchange,
+          class TwoOpt,
+          class ReverseTwoOpt,
+          class Relocate,
+          class OrOpt,
+          class IntraExchange,
+          class IntraCrossExchange,
+          class IntraMixedExchange,
+          class IntraRelocate,
+          class IntraOrOpt,
+          class IntraTwoOpt,
+          class PDShift,
+          class RouteExchange,
+          class SwapStar,
+          class RouteSplit,
+          class PriorityReplace,
+          class TSPFix>
+std::optional<unsigned>
+LocalSearch<Route,
+            UnassignedExchange,
+            CrossExchange,
+            MixedExchange,
+            TwoOpt,
+            ReverseTwoOpt,
+            Relocate,
+            OrOpt,
+            IntraExchange,
+            IntraCrossExchange,
+            IntraMixedExchange,
+            IntraRelocate,
+            IntraOrOpt,
+            IntraTwoOpt,
+            PDShift,
+            RouteExchange,
+            SwapStar,
+            RouteSplit,
+            PriorityReplace,
+            TSPFix>::completed_depth() const {
+  return _completed_depth;
+}
+
 template <class Route,
           class UnassignedExchange,
           class CrossExchange,
@@ -2170,14 +2458,14 @@ Eval LocalSearch<Route,
   }
   if (_sol[v_target].size() != 0) {
     const auto cheapest_from_rank =
-      _sol_state.cheapest_job_rank_in_routes_from[v][v_target][r];
+      _sol_state.cheapest_job_rank_in_routes_from(v, v_target, r);
     const auto cheapest_from_index =
       _input.jobs[_sol[v_target].route[cheapest_from_rank]].index();
     const auto eval_from = vehicle.eval(cheapest_from_index, job_index);
     eval = std::min(eval, eval_from);
 
     const auto cheapest_to_rank =
-      _sol_state.cheapest_job_rank_in_routes_to[v][v_target][r];
+      _sol_state.cheapest_job_rank_in_routes_to(v, v_target, r);
     const auto cheapest_to_index =
       _input.jobs[_sol[v_target].route[cheapest_to_rank]].index();
     const auto eval_to = vehicle.eval(job_index, cheapest_to_index);
@@ -2229,7 +2517,7 @@ Eval LocalSearch<Route,
                  TSPFix>::relocate_cost_lower_bound(Index v, Index r) {
   Eval best_bound = NO_EVAL;
 
-  for (std::size_t other_v = 0; other_v < _sol.size(); ++other_v) {
+  for (const auto other_v : _sol_state.route_neighbours[v]) {
     if (other_v == v ||
         !_input.vehicle_ok_with_job(other_v, _sol[v].route[r])) {
       continue;
@@ -2285,7 +2573,7 @@ Eval LocalSearch<Route,
                                                     Index r2) {
   Eval best_bound = NO_EVAL;
 
-  for (std::size_t other_v = 0; other_v < _sol.size(); ++other_v) {
+  for (const auto other_v : _sol_state.route_neighbours[v]) {
     if (other_v == v ||
         !_input.vehicle_ok_with_job(other_v, _sol[v].route[r1])) {
       continue;
@@ -2319,30 +2607,31 @@ template <class Route,
           class RouteSplit,
           class PriorityReplace,
           class TSPFix>
-void LocalSearch<Route,
-                 UnassignedExchange,
-                 CrossExchange,
-                 MixedExchange,
-                 TwoOpt,
-                 ReverseTwoOpt,
-                 Relocate,
-                 OrOpt,
-                 IntraExchange,
-                 IntraCrossExchange,
-                 IntraMixedExchange,
-                 IntraRelocate,
-                 IntraOrOpt,
-                 IntraTwoOpt,
-                 PDShift,
-                 RouteExchange,
-                 SwapStar,
-                 RouteSplit,
-                 PriorityReplace,
-                 TSPFix>::remove_from_routes() {
-  // Store nearest job from and to any job in any route for constant
-  // time access down the line.
+std::vector<Index>
+LocalSearch<Route,
+            UnassignedExchange,
+            CrossExchange,
+            MixedExchange,
+            TwoOpt,
+            ReverseTwoOpt,
+            Relocate,
+            OrOpt,
+            IntraExchange,
+            IntraCrossExchange,
+            IntraMixedExchange,
+            IntraRelocate,
+            IntraOrOpt,
+            IntraTwoOpt,
+            PDShift,
+            RouteExchange,
+            SwapStar,
+            RouteSplit,
+            PriorityReplace,
+            TSPFix>::remove_from_routes() {
+  // Store nearest job from and to any job in any neighbouring route
+  // for constant time access down the line.
   for (std::size_t v1 = 0; v1 < _nb_vehicles; ++v1) {
-    for (std::size_t v2 = 0; v2 < _nb_vehicles; ++v2) {
+    for (const auto v2 : _sol_state.route_neighbours[v1]) {
       if (v2 == v1) {
         continue;
       }
@@ -2401,17 +2690,17 @@ void LocalSearch<Route,
           if (delivery_r == r + 1) {
             valid_removal = _sol[v].is_valid_removal(_input, r, 2);
           } else {
-            std::vector<Index> between_pd(_sol[v].route.begin() + r + 1,
-                                          _sol[v].route.begin() + delivery_r);
-
+            // Jobs in between are read in place as nothing is
+            // modified upon checking.
             const auto delivery_between_pd =
               _sol[v].delivery_in_range(r + 1, delivery_r);
 
             valid_removal =
               _sol[v].is_valid_addition_for_tw(_input,
                                                delivery_between_pd,
-                                               between_pd.begin(),
-                                               between_pd.end(),
+                                               _sol[v].route.begin() + r + 1,
+                                               _sol[v].route.begin() +
+                                                 delivery_r,
                                                r,
                                                delivery_r + 1);
           }
@@ -2455,6 +2744,13 @@ void LocalSearch<Route,
       }
     }
   }
+
+  std::vector<Index> modified_vehicles;
+  modified_vehicles.reserve(routes_and_ranks.size());
+  for (const auto& [v, r] : routes_and_ranks) {
+    modified_vehicles.push_back(v);
+  }
+  return modified_vehicles;
 }
 
 template <class Route,
@@ -12,6 +12,7 @@ All rights reserved (see LICENSE).
 
 #include "structures/vroom/solution_indicators.h"
 #include "structures/vroom/solution_state.h"
+#include "utils/solution_registry.h"
 
 namespace vroom::ls {
 
@@ -41,7 +42,17 @@ private:
   const std::size_t _nb_vehicles;
 
   const unsigned _depth;
-  const Deadline _deadline;
+  Deadline _deadline;
+
+  // Max number of threads used from the input thread pool to
+  // evaluate moves for several route pairs in parallel.
+  unsigned _nb_threads;
+
+  // Solutions reached by all searches, used to stop as soon as this
+  // search (at _search_rank) reaches one reached by another search.
+  utils::SolutionRegistry* _registry;
+  const unsigned _search_rank;
+  unsigned _nb_steps{0};
 
   std::optional<unsigned> _completed_depth;
   std::vector<Index> _all_routes;
@@ -56,7 +67,9 @@ private:
   std::unordered_set<Index> try_job_additions(const std::vector<Index>& routes,
                                               double regret_coeff);
 
-  void run_ls_step();
+  // Return false if stopped on deadline before reaching a local
+  // optimum.
+  bool run_ls_step();
 
   // Compute "cost" between route at rank v_target and job with rank r
   // in route at rank v. Relies on
@@ -65,21 +78,33 @@ private:
 
   // Compute lower bound for the cost of relocating job at rank r
   // (resp. jobs at rank r1 and r2) in route v to any other
-  // (compatible) route.
+  // (compatible) route in _sol_state.route_neighbours[v]. In granular
+  // mode, other routes are ignored so this is only an estimate based
+  // on neighbour routes, not a lower bound over all routes.
   Eval relocate_cost_lower_bound(Index v, Index r);
   Eval relocate_cost_lower_bound(Index v, Index r1, Index r2);
 
-  void remove_from_routes();
+  // Return vehicles for modified routes.
+  std::vector<Index> remove_from_routes();
 
 public:
   LocalSearch(const Input& input,
               std::vector<Route>& tw_sol,
               unsigned depth,
-              const Timeout& timeout);
+              const Timeout& timeout,
+              unsigned nb_threads = 1,
+              std::optional<unsigned> completed_depth = std::nullopt,
+              utils::SolutionRegistry* registry = nullptr,
+              unsigned search_rank = 0);
 
   utils::SolutionIndicators indicators() const;
 
   void run();
+
+  // Number of job removal levels explored so far, unset until first
+  // descent is over. Passing it back to the constructor along with
+  // the solution resumes a run that stopped on its deadline.
+  std::optional<unsigned> completed_depth() const;
 };
 
 } // namespace vroom::ls
@@ -0,0 +1,124 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include "algorithms/local_search/move_cache.h"
+
+namespace vroom::ls {
+
+namespace {
+
+constexpr Eval zero_gain = Eval();
+
+// Heap ordering: higher gain first, then lowest (source, target) pair
+// to match a row-major scan of all pairs.
+bool lower_priority(const CachedMove& lhs, const CachedMove& rhs) {
+  if (lhs.gain == rhs.gain) {
+    return std::tie(rhs.source, rhs.target) < std::tie(lhs.source, lhs.target);
+  }
+  return lhs.gain < rhs.gain;
+}
+
+} // namespace
+
+MoveCache::MoveCache(std::size_t nb_vehicles) : _moves(nb_vehicles) {
+}
+
+const Eval& MoveCache::gain(Index source, Index target) const {
+  const auto& moves = _moves[source];
+  const auto search = moves.find(target);
+  return (search == moves.end()) ? zero_gain : search->second.gain;
+}
+
+Operator* MoveCache::op(Index source, Index target) const {
+  const auto& moves = _moves[source];
+  const auto search = moves.find(target);
+  return (search == moves.end()) ? nullptr : search->second.op.get();
+}
+
+void MoveCache::set(Index source,
+                    Index target,
+                    const Eval& gain,
+                    std::unique_ptr<Operator>&& op) {
+  auto [it, inserted] = _moves[source].try_emplace(target);
+  if (inserted) {
+    ++_size;
+  }
+
+  auto& entry = it->second;
+  entry.gain = gain;
+  entry.op = std::move(op);
+  if (!entry.pending) {
+    entry.pending = true;
+    _pending.emplace_back(source, target);
+  }
+}
+
+void MoveCache::erase(Index source, Index target) {
+  _size -= _moves[source].erase(target);
+}
+
+void MoveCache::erase_source(Index v) {
+  _size -= _moves[v].size();
+  _moves[v].clear();
+}
+
+bool MoveCache::is_stale(const CachedMove& m) const {
+  const auto& moves = _moves[m.source];
+  const auto search = moves.find(m.target);
+  return search == moves.end() || search->second.gain != m.gain;
+}
+
+void MoveCache::flush_pending() {
+  for (const auto& [source, target] : _pending) {
+    auto& moves = _moves[source];
+    auto search = moves.find(target);
+    if (search == moves.end() || !search->second.pending) {
+      // Either removed or already pushed.
+      continue;
+    }
+
+    search->second.pending = false;
+    _heap.push_back({search->second.gain, source, target});
+    std::push_heap(_heap.begin(), _heap.end(), lower_priority);
+  }
+  _pending.clear();
+}
+
+void MoveCache::rebuild_heap() {
+  _heap.clear();
+  for (std::size_t source = 0; source < _moves.size(); ++source) {
+    for (auto& [target, entry] : _moves[source]) {
+      entry.pending = false;
+      _heap.push_back({entry.gain, static_cast<Index>(source), target});
+    }
+  }
+  std::make_heap(_heap.begin(), _heap.end(), lower_priority);
+  _pending.clear();
+}
+
+std::optional<CachedMove> MoveCache::best() {
+  if (_heap.size() + _pending.size() > 2 * _size + _moves.size()) {
+    // Too many stale items, start over from stored moves only.
+    rebuild_heap();
+  } else {
+    flush_pending();
+  }
+
+  while (!_heap.empty() && is_stale(_heap.front())) {
+    std::pop_heap(_heap.begin(), _heap.end(), lower_priority);
+    _heap.pop_back();
+  }
+
+  if (_heap.empty()) {
+    return std::nullopt;
+  }
+  return _heap.front();
+}
+
+} // namespace vroom::ls
@@ -0,0 +1,89 @@
+#ifndef MOVE_CACHE_H
+#define MOVE_CACHE_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "algorithms/local_search/operator.h"
+
+namespace vroom::ls {
+
+struct CachedMove {
+  Eval gain;
+  Index source;
+  Index target;
+};
+
+// Best move found for a given (source, target) pair during
+// evaluation.
+struct PairMove {
+  Eval gain;
+  std::unique_ptr<Operator> op;
+};
+
+// Sparse storage for the best known move for each (source, target)
+// pair of routes. Only pairs with a stored move take up space and the
+// overall best move is retrieved from a heap in O(log n) instead of
+// scanning all pairs.
+class MoveCache {
+private:
+  struct Entry {
+    Eval gain;
+    std::unique_ptr<Operator> op;
+    // True if gain changed since last push to heap.
+    bool pending{false};
+  };
+
+  // Entries for a given source, keyed by target.
+  std::vector<std::unordered_map<Index, Entry>> _moves;
+  std::size_t _size{0};
+
+  // Heap items are only checked for staleness upon reaching the top,
+  // which happens when the matching entry has been removed or its
+  // gain has changed.
+  std::vector<CachedMove> _heap;
+  std::vector<std::pair<Index, Index>> _pending;
+
+  bool is_stale(const CachedMove& m) const;
+
+  void flush_pending();
+
+  void rebuild_heap();
+
+public:
+  explicit MoveCache(std::size_t nb_vehicles);
+
+  // Zero gain if no move is stored for this pair.
+  const Eval& gain(Index source, Index target) const;
+
+  Operator* op(Index source, Index target) const;
+
+  void set(Index source,
+           Index target,
+           const Eval& gain,
+           std::unique_ptr<Operator>&& op);
+
+  void erase(Index source, Index target);
+
+  // Remove all moves with v as source.
+  void erase_source(Index v);
+
+  // Stored move with highest gain, ties being broken using lowest
+  // (source, target) pair.
+  std::optional<CachedMove> best();
+};
+
+} // namespace vroom::ls
+
+#endif
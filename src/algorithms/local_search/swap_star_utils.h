@@ -11,6 +11,8 @@ All rights reserved (see LICENSE).
 */
 
 #include <algorithm>
+#include <array>
+#include <ranges>
 
 #include "algorithms/local_search/top_insertions.h"
 #include "structures/typedefs.h"
@@ -136,19 +138,20 @@ struct InsertionRange {
 };
 
 // Compute insertion range in source route when removing job at s_rank
-// and adding job at job_rank in source route at insertion_rank.
-inline InsertionRange get_insert_range(const std::vector<Index>& s_route,
-                                       Index s_rank,
-                                       Index job_rank,
-                                       Index insertion_rank) {
-  InsertionRange insert;
+// and adding job at job_rank in source route at insertion_rank. The
+// range vector in insert is overwritten, reusing its capacity.
+inline void get_insert_range(const std::vector<Index>& s_route,
+                             Index s_rank,
+                             Index job_rank,
+                             Index insertion_rank,
+                             InsertionRange& insert) {
+  insert.range.clear();
   if (s_rank == insertion_rank) {
     insert.range.push_back(job_rank);
     insert.first_rank = s_rank;
     insert.last_rank = s_rank + 1;
   } else {
     if (s_rank < insertion_rank) {
-      insert.range.reserve(insertion_rank - s_rank);
       std::copy(s_route.begin() + s_rank + 1,
                 s_route.begin() + insertion_rank,
                 std::back_inserter(insert.range));
@@ -156,7 +159,6 @@ inline InsertionRange get_insert_range(const std::vector<Index>& s_route,
       insert.first_rank = s_rank;
       insert.last_rank = insertion_rank;
     } else {
-      insert.range.reserve(s_rank - insertion_rank + 1);
       insert.range.push_back(job_rank);
       std::copy(s_route.begin() + insertion_rank,
                 s_route.begin() + s_rank,
@@ -165,7 +167,14 @@ inline InsertionRange get_insert_range(const std::vector<Index>& s_route,
       insert.last_rank = s_rank + 1;
     }
   }
+}
 
+inline InsertionRange get_insert_range(const std::vector<Index>& s_route,
+                                       Index s_rank,
+                                       Index job_rank,
+                                       Index insertion_rank) {
+  InsertionRange insert;
+  get_insert_range(s_route, s_rank, job_rank, insertion_rank, insert);
   return insert;
 }
 
@@ -217,6 +226,17 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
   const auto& t_delivery_margin = target.delivery_margin();
   const auto& t_pickup_margin = target.pickup_margin();
 
+  // Buffers reused across all (s_rank, t_rank) pairs. Insertion
+  // ranges can't be longer than the route they apply to.
+  constexpr std::size_t MAX_SWAP_CHOICES = 16;
+  std::array<SwapChoice, MAX_SWAP_CHOICES> swap_choice_options;
+  std::size_t nb_swap_choices;
+
+  InsertionRange s_insert;
+  s_insert.range.reserve(source.route.size());
+  InsertionRange t_insert;
+  t_insert.range.reserve(target.route.size());
+
   for (unsigned s_rank = 0; s_rank < source.route.size(); ++s_rank) {
     const auto& target_insertions = top_insertions_in_target[s_rank];
     if (target_insertions[0].cost == NO_EVAL) {
@@ -265,9 +285,7 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
                                    source.route,
                                    s_rank);
 
-      std::vector<SwapChoice> swap_choice_options;
-      constexpr std::size_t MAX_SWAP_CHOICES = 16;
-      swap_choice_options.reserve(MAX_SWAP_CHOICES);
+      nb_swap_choices = 0;
 
       // Options for in-place insertion in source route include
       // in-place insertion in target route and other relevant
@@ -289,7 +307,8 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
                                                t_vehicle,
                                                target,
                                                sc)) {
-            swap_choice_options.push_back(std::move(sc));
+            assert(nb_swap_choices < MAX_SWAP_CHOICES);
+            swap_choice_options[nb_swap_choices++] = std::move(sc);
           }
         }
 
@@ -307,7 +326,8 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
                                                    t_vehicle,
                                                    target,
                                                    sc)) {
-                swap_choice_options.push_back(std::move(sc));
+                assert(nb_swap_choices < MAX_SWAP_CHOICES);
+                swap_choice_options[nb_swap_choices++] = std::move(sc);
               }
             }
           }
@@ -339,7 +359,8 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
                                                  t_vehicle,
                                                  target,
                                                  sc)) {
-              swap_choice_options.push_back(std::move(sc));
+              assert(nb_swap_choices < MAX_SWAP_CHOICES);
+              swap_choice_options[nb_swap_choices++] = std::move(sc);
             }
           }
 
@@ -357,7 +378,8 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
                                                      t_vehicle,
                                                      target,
                                                      sc)) {
-                  swap_choice_options.push_back(std::move(sc));
+                  assert(nb_swap_choices < MAX_SWAP_CHOICES);
+                  swap_choice_options[nb_swap_choices++] = std::move(sc);
                 }
               }
             }
@@ -365,11 +387,12 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
         }
       }
 
-      std::ranges::sort(swap_choice_options, SwapChoiceCmp);
-
-      assert(swap_choice_options.size() <= MAX_SWAP_CHOICES);
+      const std::ranges::subrange
+        options(swap_choice_options.begin(),
+                swap_choice_options.begin() + nb_swap_choices);
+      std::ranges::sort(options, SwapChoiceCmp);
 
-      for (const auto& sc : swap_choice_options) {
+      for (const auto& sc : options) {
         // Browse interesting options by decreasing gain and check for
         // validity.
 
@@ -388,10 +411,11 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
           continue;
         }
 
-        const auto s_insert = get_insert_range(source.route,
-                                               s_rank,
-                                               target.route[t_rank],
-                                               sc.insertion_in_source);
+        get_insert_range(source.route,
+                         s_rank,
+                         target.route[t_rank],
+                         sc.insertion_in_source,
+                         s_insert);
 
         Amount source_pickup = input.zero_amount();
         Amount source_delivery = input.zero_amount();
@@ -429,10 +453,11 @@ SwapChoice compute_best_swap_star_choice(const Input& input,
                                                        s_insert.last_rank);
 
         if (source_valid) {
-          const auto t_insert = get_insert_range(target.route,
-                                                 t_rank,
-                                                 source.route[s_rank],
-                                                 sc.insertion_in_target);
+          get_insert_range(target.route,
+                           t_rank,
+                           source.route[s_rank],
+                           sc.insertion_in_target,
+                           t_insert);
 
           Amount target_pickup = input.zero_amount();
           Amount target_delivery = input.zero_amount();
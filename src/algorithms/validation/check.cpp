@@ -8,9 +8,6 @@ All rights reserved (see LICENSE).
 */
 
 #include <algorithm>
-#include <exception>
-#include <mutex>
-#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -59,39 +56,20 @@ check_and_set_ETA(const Input& input,
 
   std::vector<Route> routes(actual_route_rank);
 
-  std::exception_ptr ep = nullptr;
-  std::mutex ep_m;
-
-  auto run_check = [&v_rank_to_actual_route_rank, &routes, &input, &ep, &ep_m](
+  auto run_check = [&v_rank_to_actual_route_rank, &routes, &input](
                      const std::vector<Index>& vehicle_ranks) {
-    try {
-      for (auto v : vehicle_ranks) {
-        auto search = v_rank_to_actual_route_rank.find(v);
-        assert(search != v_rank_to_actual_route_rank.end());
-        const auto route_rank = search->second;
+    for (auto v : vehicle_ranks) {
+      auto search = v_rank_to_actual_route_rank.find(v);
+      assert(search != v_rank_to_actual_route_rank.end());
+      const auto route_rank = search->second;
 
-        routes[route_rank] = choose_ETA(input, v, input.vehicles[v].steps);
-      }
-    } catch (...) {
-      const std::scoped_lock<std::mutex> lock(ep_m);
-      ep = std::current_exception();
+      routes[route_rank] = choose_ETA(input, v, input.vehicles[v].steps);
     }
   };
 
-  std::vector<std::thread> solving_threads;
-  solving_threads.reserve(thread_ranks.size());
-
-  for (const auto& v_ranks : thread_ranks) {
-    solving_threads.emplace_back(run_check, v_ranks);
-  }
-
-  for (auto& t : solving_threads) {
-    t.join();
-  }
-
-  if (ep != nullptr) {
-    std::rethrow_exception(ep);
-  }
+  input.thread_pool().parallel_for(thread_ranks.size(), [&](std::size_t i) {
+    run_check(thread_ranks[i]);
+  });
 
   // Handle unassigned jobs.
   std::vector<Job> unassigned_jobs;
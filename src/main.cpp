@@ -54,6 +54,9 @@ int main(int argc, char** argv) {
     ("c,choose-eta",
      "choose ETA for custom routes and report violations",
      cxxopts::value<bool>(cl_args.check)->default_value("false"))
+    ("coordinates-precision",
+     "merge locations whose coordinates are equal once rounded to this number of decimals",
+     cxxopts::value<std::optional<unsigned>>(cl_args.coords_precision))
     ("g,geometry",
      "add detailed route geometry and distance",
      cxxopts::value<bool>(cl_args.geometry)->default_value("false"))
@@ -64,6 +67,15 @@ int main(int argc, char** argv) {
     ("l,limit",
      "stop solving process after 'limit' seconds",
      cxxopts::value<std::string>(limit_arg))
+    ("m,matrix-file",
+     "binary matrix file to use for the profile set in its header, can be repeated",
+     cxxopts::value<std::vector<std::string>>(cl_args.matrix_files))
+    ("matrix-cache",
+     "directory used to store and reuse matrices computed by the routing engine",
+     cxxopts::value<std::string>(cl_args.matrix_cache_dir))
+    ("matrix-block-size",
+     "max number of sources and destinations per matrix request to the routing engine, 0 for no limit",
+     cxxopts::value<std::size_t>(cl_args.matrix_block_size)->default_value("0"))
     ("o,output",
      "write output to a file rather than stdout",
      cxxopts::value<std::string>(output_file))
@@ -231,7 +243,21 @@ int main(int argc, char** argv) {
     vroom::Input problem_instance(cl_args.servers,
                                   cl_args.router,
                                   cl_args.apply_TSPFix);
+    if (cl_args.coords_precision.has_value()) {
+      problem_instance.set_coordinates_precision(
+        cl_args.coords_precision.value());
+    }
     vroom::io::parse(problem_instance, cl_args.input, cl_args.geometry);
+    for (const auto& matrix_file : cl_args.matrix_files) {
+      problem_instance.set_matrix_file(matrix_file);
+    }
+    problem_instance.set_matrix_block_size(cl_args.matrix_block_size);
+    if (!cl_args.matrix_cache_dir.empty()) {
+      problem_instance.set_matrix_cache(
+        std::make_shared<vroom::routing::MatrixCache>(
+          vroom::DEFAULT_MATRIX_CACHE_CAPACITY,
+          cl_args.matrix_cache_dir));
+    }
 
     const vroom::Solution sol = (cl_args.check)
                                   ? problem_instance.check(cl_args.nb_threads)
@@ -33,7 +33,6 @@ IntraCrossExchange::IntraCrossExchange(const Input& input,
     // check_t_reverse are false.
     check_s_reverse(check_s_reverse),
     check_t_reverse(check_t_reverse),
-    _moved_jobs(t_rank - s_rank + 2),
     _first_rank(s_rank),
     _last_rank(t_rank + 2),
     _delivery(source.delivery_in_range(_first_rank, _last_rank)) {
@@ -57,7 +56,10 @@ IntraCrossExchange::IntraCrossExchange(const Input& input,
           _input.jobs[this->t_route[t_rank + 1]].type == JOB_TYPE::DELIVERY &&
           !check_t_reverse &&
           _sol_state.matching_delivery_rank[t_vehicle][t_rank] == t_rank + 1));
+}
 
+void IntraCrossExchange::set_moved_jobs() {
+  _moved_jobs.resize(_last_rank - _first_rank);
   _moved_jobs[0] = s_route[t_rank];
   _moved_jobs[1] = s_route[t_rank + 1];
   std::copy(s_route.begin() + s_rank + 2,
@@ -154,6 +156,8 @@ void IntraCrossExchange::compute_gain() {
 bool IntraCrossExchange::is_valid() {
   assert(_gain_upper_bound_computed);
 
+  set_moved_jobs();
+
   const auto& s_v = _input.vehicles[s_vehicle];
   const auto& s_eval = _sol_state.route_evals[s_vehicle];
   const auto s_normal_t_normal_eval = _normal_s_gain + _normal_t_gain;
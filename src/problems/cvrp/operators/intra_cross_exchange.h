@@ -33,6 +33,8 @@ protected:
   bool s_reverse_t_reverse_is_valid{false};
   bool s_reverse_t_normal_is_valid{false};
 
+  // Only filled upon validity check as most candidates are discarded
+  // based on gain.
   std::vector<Index> _moved_jobs;
   const Index _first_rank;
   const Index _last_rank;
@@ -40,6 +42,8 @@ protected:
 
   void compute_gain() override;
 
+  void set_moved_jobs();
+
 public:
   IntraCrossExchange(const Input& input,
                      const utils::SolutionState& sol_state,
@@ -27,7 +27,6 @@ IntraExchange::IntraExchange(const Input& input,
              s_raw_route,
              s_vehicle,
              t_rank),
-    _moved_jobs(t_rank - s_rank + 1),
     _first_rank(s_rank),
     _last_rank(t_rank + 1),
     _delivery(source.delivery_in_range(_first_rank, _last_rank)) {
@@ -37,7 +36,10 @@ IntraExchange::IntraExchange(const Input& input,
   assert(s_rank < t_rank - 1);
   assert(s_route.size() >= 3);
   assert(t_rank < s_route.size());
+}
 
+void IntraExchange::set_moved_jobs() {
+  _moved_jobs.resize(_last_rank - _first_rank);
   std::copy(s_route.begin() + _first_rank,
             s_route.begin() + _last_rank,
             _moved_jobs.begin());
@@ -64,8 +66,13 @@ void IntraExchange::compute_gain() {
 }
 
 bool IntraExchange::is_valid() {
-  return is_valid_for_range_bounds() &&
-         source.is_valid_addition_for_capacity_inclusion(_input,
+  if (!is_valid_for_range_bounds()) {
+    return false;
+  }
+
+  set_moved_jobs();
+
+  return source.is_valid_addition_for_capacity_inclusion(_input,
                                                          _delivery,
                                                          _moved_jobs.begin(),
                                                          _moved_jobs.end(),
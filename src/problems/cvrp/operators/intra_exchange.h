@@ -16,6 +16,8 @@ namespace vroom::cvrp {
 
 class IntraExchange : public ls::Operator {
 protected:
+  // Only filled upon validity check as most candidates are discarded
+  // based on gain.
   std::vector<Index> _moved_jobs;
   const Index _first_rank;
   const Index _last_rank;
@@ -23,6 +25,8 @@ protected:
 
   void compute_gain() override;
 
+  void set_moved_jobs();
+
 public:
   IntraExchange(const Input& input,
                 const utils::SolutionState& sol_state,
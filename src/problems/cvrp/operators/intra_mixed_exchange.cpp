@@ -31,7 +31,6 @@ IntraMixedExchange::IntraMixedExchange(const Input& input,
     // Required for consistency in compute_gain if check_t_reverse is
     // false.
     check_t_reverse(check_t_reverse),
-    _moved_jobs((s_rank < t_rank) ? t_rank - s_rank + 2 : s_rank - t_rank + 1),
     _first_rank(std::min(s_rank, t_rank)),
     _last_rank((t_rank < s_rank) ? s_rank + 1 : t_rank + 2),
     _delivery(source.delivery_in_range(_first_rank, _last_rank)) {
@@ -51,18 +50,26 @@ IntraMixedExchange::IntraMixedExchange(const Input& input,
           !check_t_reverse &&
           _sol_state.matching_delivery_rank[t_vehicle][t_rank] == t_rank + 1));
 
+  if (t_rank < s_rank) {
+    _t_edge_first = _last_rank - _first_rank - 2;
+    _t_edge_last = _last_rank - _first_rank - 1;
+  } else {
+    _t_edge_first = 0;
+    _t_edge_last = 1;
+  }
+}
+
+void IntraMixedExchange::set_moved_jobs() {
+  _moved_jobs.resize(_last_rank - _first_rank);
+
   Index s_node;
   if (t_rank < s_rank) {
     s_node = 0;
-    _t_edge_first = _moved_jobs.size() - 2;
-    _t_edge_last = _moved_jobs.size() - 1;
 
     std::copy(s_route.begin() + t_rank + 2,
               s_route.begin() + s_rank,
               _moved_jobs.begin() + 1);
   } else {
-    _t_edge_first = 0;
-    _t_edge_last = 1;
     s_node = _moved_jobs.size() - 1;
 
     std::copy(s_route.begin() + s_rank + 1,
@@ -135,6 +142,8 @@ void IntraMixedExchange::compute_gain() {
 bool IntraMixedExchange::is_valid() {
   assert(_gain_upper_bound_computed);
 
+  set_moved_jobs();
+
   const auto& s_v = _input.vehicles[s_vehicle];
   const auto& s_eval = _sol_state.route_evals[s_vehicle];
   const auto normal_eval = _normal_s_gain + t_gain;
@@ -31,7 +31,6 @@ IntraOrOpt::IntraOrOpt(const Input& input,
     // Required for consistency in compute_gain if check_reverse is
     // false.
     check_reverse(check_reverse),
-    _moved_jobs((s_rank < t_rank) ? t_rank - s_rank + 2 : s_rank - t_rank + 2),
     _first_rank(std::min(s_rank, t_rank)),
     _last_rank(std::max(s_rank, t_rank) + 2),
     _delivery(source.delivery_in_range(_first_rank, _last_rank)) {
@@ -51,14 +50,19 @@ IntraOrOpt::IntraOrOpt(const Input& input,
   if (t_rank < s_rank) {
     _s_edge_first = 0;
     _s_edge_last = 1;
+  } else {
+    _s_edge_first = _last_rank - _first_rank - 2;
+    _s_edge_last = _last_rank - _first_rank - 1;
+  }
+}
 
+void IntraOrOpt::set_moved_jobs() {
+  _moved_jobs.resize(_last_rank - _first_rank);
+  if (t_rank < s_rank) {
     std::copy(s_route.begin() + t_rank,
               s_route.begin() + s_rank,
               _moved_jobs.begin() + 2);
   } else {
-    _s_edge_first = _moved_jobs.size() - 2;
-    _s_edge_last = _moved_jobs.size() - 1;
-
     std::copy(s_route.begin() + s_rank + 2,
               s_route.begin() + t_rank + 2,
               _moved_jobs.begin());
@@ -126,6 +130,8 @@ void IntraOrOpt::compute_gain() {
 bool IntraOrOpt::is_valid() {
   assert(_gain_upper_bound_computed);
 
+  set_moved_jobs();
+
   const auto& s_v = _input.vehicles[s_vehicle];
   const auto& s_eval = _sol_state.route_evals[s_vehicle];
   const auto normal_eval = s_gain + _normal_t_gain;
@@ -27,6 +27,8 @@ protected:
   bool is_reverse_valid{false};
   const bool check_reverse;
 
+  // Only filled upon validity check as most candidates are discarded
+  // based on gain.
   std::vector<Index> _moved_jobs;
   const Index _first_rank;
   const Index _last_rank;
@@ -36,6 +38,8 @@ protected:
 
   void compute_gain() override;
 
+  void set_moved_jobs();
+
 public:
   IntraOrOpt(const Input& input,
              const utils::SolutionState& sol_state,
@@ -27,7 +27,6 @@ IntraRelocate::IntraRelocate(const Input& input,
              s_raw_route,
              s_vehicle,
              t_rank),
-    _moved_jobs((s_rank < t_rank) ? t_rank - s_rank + 1 : s_rank - t_rank + 1),
     _first_rank(std::min(s_rank, t_rank)),
     _last_rank(std::max(s_rank, t_rank) + 1),
     _delivery(source.delivery_in_range(_first_rank, _last_rank)) {
@@ -35,7 +34,10 @@ IntraRelocate::IntraRelocate(const Input& input,
   assert(s_rank < s_route.size());
   assert(t_rank <= s_route.size() - 1);
   assert(s_rank != t_rank);
+}
 
+void IntraRelocate::set_moved_jobs() {
+  _moved_jobs.resize(_last_rank - _first_rank);
   if (t_rank < s_rank) {
     _moved_jobs[0] = s_route[s_rank];
     std::copy(s_route.begin() + t_rank,
@@ -67,8 +69,13 @@ void IntraRelocate::compute_gain() {
 }
 
 bool IntraRelocate::is_valid() {
-  return is_valid_for_range_bounds() &&
-         source.is_valid_addition_for_capacity_inclusion(_input,
+  if (!is_valid_for_range_bounds()) {
+    return false;
+  }
+
+  set_moved_jobs();
+
+  return source.is_valid_addition_for_capacity_inclusion(_input,
                                                          _delivery,
                                                          _moved_jobs.begin(),
                                                          _moved_jobs.end(),
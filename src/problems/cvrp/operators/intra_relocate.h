@@ -18,6 +18,10 @@ class IntraRelocate : public ls::Operator {
 protected:
   void compute_gain() override;
 
+  void set_moved_jobs();
+
+  // Only filled upon validity check as most candidates are discarded
+  // based on gain.
   std::vector<Index> _moved_jobs;
   const Index _first_rank;
   const Index _last_rank;
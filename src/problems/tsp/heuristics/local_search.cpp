@@ -11,7 +11,6 @@ All rights reserved (see LICENSE).
 #include <iterator>
 #include <numeric>
 #include <ranges>
-#include <thread>
 #include <unordered_map>
 
 #include "problems/tsp/heuristics/local_search.h"
@@ -22,10 +21,12 @@ namespace vroom::tsp {
 LocalSearch::LocalSearch(const Matrix<UserCost>& matrix,
                          std::pair<bool, Index> avoid_start_relocate,
                          const std::list<Index>& tour,
+                         utils::ThreadPool& pool,
                          unsigned nb_threads)
   : _matrix(matrix),
     _avoid_start_relocate(std::move(avoid_start_relocate)),
     _edges(_matrix.size()),
+    _pool(pool),
     _nb_threads(std::min(nb_threads, static_cast<unsigned>(tour.size()))),
     _rank_limits(_nb_threads) {
   // Build _edges vector representation.
@@ -169,21 +170,13 @@ UserCost LocalSearch::relocate_step() {
   std::vector<Index> best_edge_1_starts(_nb_threads);
   std::vector<Index> best_edge_2_starts(_nb_threads);
 
-  std::vector<std::thread> threads;
-  threads.reserve(_nb_threads);
-
-  for (std::size_t i = 0; i < _nb_threads; ++i) {
-    threads.emplace_back(look_up,
-                         _rank_limits[i],
-                         _rank_limits[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  for (auto& t : threads) {
-    t.join();
-  }
+  _pool.parallel_for(_nb_threads, [&](std::size_t i) {
+    look_up(_rank_limits[i],
+            _rank_limits[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
   // Spot best gain found among all threads.
   auto best_rank =
@@ -431,23 +424,13 @@ UserCost LocalSearch::two_opt_step() {
   std::vector<Index> best_edge_1_starts(_nb_threads);
   std::vector<Index> best_edge_2_starts(_nb_threads);
 
-  // Start other threads, keeping a piece of the range for the main
-  // thread.
-  std::vector<std::thread> threads;
-  threads.reserve(_nb_threads);
-
-  for (std::size_t i = 0; i < _nb_threads; ++i) {
-    threads.emplace_back(look_up,
-                         _sym_two_opt_rank_limits[i],
-                         _sym_two_opt_rank_limits[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  for (auto& t : threads) {
-    t.join();
-  }
+  _pool.parallel_for(_nb_threads, [&](std::size_t i) {
+    look_up(_sym_two_opt_rank_limits[i],
+            _sym_two_opt_rank_limits[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
   // Spot best gain found among all threads.
   auto best_rank =
@@ -569,21 +552,13 @@ UserCost LocalSearch::asym_two_opt_step() {
   }
   limit_nodes.push_back(init);
 
-  std::vector<std::thread> threads;
-  threads.reserve(_nb_threads);
-
-  for (std::size_t i = 0; i < _nb_threads; ++i) {
-    threads.emplace_back(look_up,
-                         limit_nodes[i],
-                         limit_nodes[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  for (auto& t : threads) {
-    t.join();
-  }
+  _pool.parallel_for(_nb_threads, [&](std::size_t i) {
+    look_up(limit_nodes[i],
+            limit_nodes[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
   // Spot best gain found among all threads.
   auto best_rank =
@@ -707,21 +682,13 @@ UserCost LocalSearch::or_opt_step() {
   std::vector<Index> best_edge_1_starts(_nb_threads);
   std::vector<Index> best_edge_2_starts(_nb_threads);
 
-  std::vector<std::thread> threads;
-  threads.reserve(_nb_threads);
-
-  for (std::size_t i = 0; i < _nb_threads; ++i) {
-    threads.emplace_back(look_up,
-                         _rank_limits[i],
-                         _rank_limits[i + 1],
-                         std::ref(best_gains[i]),
-                         std::ref(best_edge_1_starts[i]),
-                         std::ref(best_edge_2_starts[i]));
-  }
-
-  for (auto& t : threads) {
-    t.join();
-  }
+  _pool.parallel_for(_nb_threads, [&](std::size_t i) {
+    look_up(_rank_limits[i],
+            _rank_limits[i + 1],
+            best_gains[i],
+            best_edge_1_starts[i],
+            best_edge_2_starts[i]);
+  });
 
   // Spot best gain found among all threads.
   auto best_rank =
@@ -12,6 +12,7 @@ All rights reserved (see LICENSE).
 
 #include "structures/generic/matrix.h"
 #include "structures/typedefs.h"
+#include "utils/thread_pool.h"
 
 namespace vroom::tsp {
 
@@ -20,6 +21,7 @@ private:
   const Matrix<UserCost>& _matrix;
   const std::pair<bool, Index> _avoid_start_relocate;
   std::vector<Index> _edges;
+  utils::ThreadPool& _pool;
   unsigned _nb_threads;
   std::vector<Index> _rank_limits;
   std::vector<Index> _sym_two_opt_rank_limits;
@@ -28,6 +30,7 @@ public:
   LocalSearch(const Matrix<UserCost>& matrix,
               std::pair<bool, Index> avoid_start_relocate,
               const std::list<Index>& tour,
+              utils::ThreadPool& pool,
               unsigned nb_threads);
 
   UserCost relocate_step();
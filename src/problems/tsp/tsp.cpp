@@ -198,6 +198,7 @@ std::vector<Index> TSP::raw_solve(unsigned nb_threads,
                           std::make_pair(!_round_trip && _has_start && _has_end,
                                          _start),
                           christo_sol,
+                          _input.thread_pool(),
                           nb_threads);
 
   UserCost sym_two_opt_gain = 0;
@@ -241,6 +242,7 @@ std::vector<Index> TSP::raw_solve(unsigned nb_threads,
       asym_ls(_matrix,
               std::make_pair(!_round_trip && _has_start && _has_end, _start),
               (direct_cost <= reverse_cost) ? current_sol : reverse_current_sol,
+              _input.thread_pool(),
               nb_threads);
 
     UserCost asym_two_opt_gain = 0;
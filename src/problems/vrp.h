@@ -11,18 +11,20 @@ All rights reserved (see LICENSE).
 */
 
 #include <algorithm>
+#include <bit>
+#include <chrono>
 #include <mutex>
 #include <numeric>
+#include <optional>
 #include <ranges>
-#include <semaphore>
 #include <set>
-#include <thread>
 
 #include "algorithms/heuristics/heuristics.h"
 #include "algorithms/local_search/local_search.h"
 #include "structures/vroom/eval.h"
 #include "structures/vroom/input/input.h"
 #include "structures/vroom/solution/solution.h"
+#include "utils/solution_registry.h"
 
 namespace vroom {
 
@@ -54,11 +56,15 @@ template <class Route> struct SolvingContext {
   std::set<utils::SolutionIndicators> heuristic_indicators;
   std::mutex heuristic_indicators_m;
 
-  SolvingContext(const Input& input, unsigned nb_searches)
+  // Solutions reached during local search.
+  utils::SolutionRegistry ls_registry;
+
+  SolvingContext(const Input& input, unsigned nb_searches, bool in_rounds)
     : init_sol(set_init_sol<Route>(input, init_assigned)),
       vehicles_ranks(input.vehicles.size()),
       solutions(nb_searches, init_sol),
-      sol_indicators(nb_searches) {
+      sol_indicators(nb_searches),
+      ls_registry(nb_searches, in_rounds) {
 
     // Deduce unassigned jobs from initial solution.
     std::ranges::copy_if(std::views::iota(0u, input.jobs.size()),
@@ -81,15 +87,12 @@ template <class Route> struct SolvingContext {
   }
 };
 
-template <class Route, class LocalSearch>
-void run_single_search(const Input& input,
-                       const HeuristicParameters& p,
-                       const unsigned rank,
-                       const unsigned depth,
-                       const Timeout& search_time,
-                       SolvingContext<Route>& context) {
-  const auto heuristic_start = utils::now();
-
+template <class Route>
+void run_heuristic(const Input& input,
+                   const HeuristicParameters& p,
+                   const unsigned rank,
+                   const unsigned nb_threads,
+                   SolvingContext<Route>& context) {
   Eval h_eval;
   switch (p.heuristic) {
   case HEURISTIC::BASIC:
@@ -99,7 +102,8 @@ void run_single_search(const Input& input,
                                       context.vehicles_ranks,
                                       p.init,
                                       p.regret_coeff,
-                                      p.sort);
+                                      p.sort,
+                                      nb_threads);
     break;
   case HEURISTIC::DYNAMIC:
     h_eval = heuristics::dynamic_vehicle_choice<Route>(input,
@@ -108,7 +112,8 @@ void run_single_search(const Input& input,
                                                        context.vehicles_ranks,
                                                        p.init,
                                                        p.regret_coeff,
-                                                       p.sort);
+                                                       p.sort,
+                                                       nb_threads);
     break;
   }
 
@@ -126,7 +131,8 @@ void run_single_search(const Input& input,
                                               context.vehicles_ranks,
                                               p.init,
                                               p.regret_coeff,
-                                              SORT::COST);
+                                              SORT::COST,
+                                              nb_threads);
       break;
     case HEURISTIC::DYNAMIC:
       h_other_eval =
@@ -136,7 +142,8 @@ void run_single_search(const Input& input,
                                                   context.vehicles_ranks,
                                                   p.init,
                                                   p.regret_coeff,
-                                                  SORT::COST);
+                                                  SORT::COST,
+                                                  nb_threads);
       break;
     }
 
@@ -145,39 +152,184 @@ void run_single_search(const Input& input,
     }
   }
 
-  // Check if heuristic solution has been encountered before.
   context.sol_indicators[rank] =
     utils::SolutionIndicators(input, context.solutions[rank]);
+}
 
-  const auto heuristic_end = utils::now();
+template <class Route, class LocalSearch>
+void run_single_search(const Input& input,
+                       const HeuristicParameters& p,
+                       const unsigned rank,
+                       const unsigned depth,
+                       const unsigned ls_nb_threads,
+                       SolvingContext<Route>& context) {
+  // Higher-ranked searches wait on this one in the registry, even
+  // upon exception or skipped local search.
+  struct RegistryGuard {
+    utils::SolutionRegistry& registry;
+    const unsigned rank;
+    ~RegistryGuard() {
+      registry.finish(rank);
+    }
+  } const guard{context.ls_registry, rank};
+
+  run_heuristic<Route>(input, p, rank, ls_nb_threads, context);
 
+  // Check if heuristic solution has been encountered before.
   if (context.heuristic_solution_already_found(rank)) {
     // Duplicate heuristic solution, so skip local search.
     return;
   }
 
-  Timeout ls_search_time;
-  if (search_time.has_value()) {
-    const auto heuristic_time =
-      std::chrono::duration_cast<std::chrono::milliseconds>(heuristic_end -
-                                                            heuristic_start);
-
-    if (search_time.value() <= heuristic_time) {
-      // No time left for local search!
-      return;
-    }
-
-    ls_search_time = search_time.value() - heuristic_time;
-  }
-
   // Local search phase.
-  LocalSearch ls(input, context.solutions[rank], depth, ls_search_time);
+  LocalSearch ls(input,
+                 context.solutions[rank],
+                 depth,
+                 Timeout(),
+                 ls_nb_threads,
+                 std::nullopt,
+                 &context.ls_registry,
+                 rank);
   ls.run();
 
   // Store solution indicators.
   context.sol_indicators[rank] = ls.indicators();
 }
 
+// Run searches within timeout, starting with all heuristics. Local
+// search then runs in successive halving rounds: each round gets an
+// equal share of remaining time, and only the best half of searches
+// that have not completed is resumed in next round. Remaining time
+// and threads thus go to the most promising searches instead of
+// being split equally upfront.
+template <class Route, class LocalSearch>
+void run_adaptive_searches(const Input& input,
+                           const std::vector<HeuristicParameters>& parameters,
+                           const unsigned nb_searches,
+                           const unsigned depth,
+                           const unsigned nb_threads,
+                           const Timeout& timeout,
+                           SolvingContext<Route>& context) {
+  assert(timeout.has_value());
+  const auto deadline = utils::now() + timeout.value();
+
+  const auto h_nb_threads = std::min(nb_searches, nb_threads);
+  input.thread_pool().parallel_for(
+    nb_searches,
+    [&](const std::size_t rank) {
+      run_heuristic<Route>(input,
+                           parameters[rank],
+                           rank,
+                           nb_threads / h_nb_threads,
+                           context);
+    },
+    h_nb_threads);
+
+  // Searches to run, skipping duplicate heuristic solutions.
+  std::vector<Index> ranks;
+  for (Index rank = 0; rank < nb_searches; ++rank) {
+    if (!context.heuristic_solution_already_found(rank)) {
+      ranks.push_back(rank);
+    }
+  }
+
+  // Only solutions and explored job removal levels are kept between
+  // rounds, searches are rebuilt from there so that at most one
+  // search per thread is alive at any time.
+  std::vector<std::optional<unsigned>> completed_depths(nb_searches);
+
+  while (!ranks.empty()) {
+    const auto round_start = utils::now();
+    if (deadline <= round_start) {
+      break;
+    }
+
+    // Solutions reached so far are checked against during this round.
+    context.ls_registry.start_round();
+
+    // Number of rounds left to get down to a single search.
+    const unsigned nb_rounds = std::bit_width(ranks.size() - 1) + 1;
+
+    const auto round_nb_threads =
+      std::min(static_cast<unsigned>(ranks.size()), nb_threads);
+    const unsigned ls_nb_threads = nb_threads / round_nb_threads;
+
+    // Searches beyond the number of threads run one after another in
+    // the round.
+    const auto nb_waves =
+      (ranks.size() + round_nb_threads - 1) / round_nb_threads;
+    const auto search_time =
+      (deadline - round_start) /
+      static_cast<TimePoint::rep>(nb_rounds * nb_waves);
+
+    input.thread_pool().parallel_for(
+      ranks.size(),
+      [&](const std::size_t i) {
+        const auto search_start = utils::now();
+        if (deadline <= search_start) {
+          return;
+        }
+
+        const auto rank = ranks[i];
+        const Timeout search_timeout =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::min(search_start + search_time, deadline) - search_start);
+        LocalSearch search(input,
+                           context.solutions[rank],
+                           depth,
+                           search_timeout,
+                           ls_nb_threads,
+                           completed_depths[rank],
+                           &context.ls_registry,
+                           rank);
+        search.run();
+        completed_depths[rank] = search.completed_depth();
+        context.sol_indicators[rank] = search.indicators();
+      },
+      round_nb_threads);
+
+    // Searches that reached the same solution would explore the same
+    // moves from there on. Only keep the one that explored the most
+    // job removal levels, then the one with lowest rank. This is only
+    // done between rounds so the search going on does not depend on
+    // thread scheduling.
+    std::vector<Index> distinct_ranks;
+    for (auto rank : ranks) {
+      const auto same_sol =
+        std::ranges::find_if(distinct_ranks, [&](const Index other) {
+          return std::ranges::equal(context.solutions[rank],
+                                    context.solutions[other],
+                                    [](const auto& lhs, const auto& rhs) {
+                                      return lhs.route == rhs.route;
+                                    });
+        });
+      if (same_sol == distinct_ranks.end()) {
+        distinct_ranks.push_back(rank);
+        continue;
+      }
+
+      const auto& rank_depth = completed_depths[rank];
+      const auto& kept_depth = completed_depths[*same_sol];
+      if (kept_depth < rank_depth ||
+          (kept_depth == rank_depth && rank < *same_sol)) {
+        std::swap(*same_sol, rank);
+      }
+    }
+    ranks = std::move(distinct_ranks);
+
+    std::erase_if(ranks, [&](const Index rank) {
+      return completed_depths[rank].has_value() &&
+             depth <= completed_depths[rank].value();
+    });
+
+    // Keep best half of searches for next round.
+    std::ranges::stable_sort(ranks, [&](const Index lhs, const Index rhs) {
+      return context.sol_indicators[lhs] < context.sol_indicators[rhs];
+    });
+    ranks.resize((ranks.size() + 1) / 2);
+  }
+}
+
 class VRP {
   // Abstract class describing a VRP (vehicle routing problem).
 protected:
@@ -202,60 +354,40 @@ protected:
     nb_searches =
       std::min(nb_searches, static_cast<unsigned>(parameters.size()));
 
-    SolvingContext<Route> context(_input, nb_searches);
-
-    std::exception_ptr ep = nullptr;
-    std::mutex ep_m;
+    SolvingContext<Route> context(_input, nb_searches, timeout.has_value());
 
-    const auto actual_nb_threads = std::min(nb_searches, nb_threads);
-    assert(actual_nb_threads <= 32);
-    std::counting_semaphore<32> semaphore(actual_nb_threads);
-
-    Timeout search_time;
+    // When there are less searches than available threads, spare
+    // threads are used to scan candidate jobs in heuristics and
+    // evaluate moves in parallel within each local search.
     if (timeout.has_value()) {
-      // Max number of solving per thread.
-      const auto dv = std::div(static_cast<long>(nb_searches),
-                               static_cast<long>(actual_nb_threads));
-      const unsigned max_solving_number = dv.quot + ((dv.rem == 0) ? 0 : 1);
-      search_time = timeout.value() / max_solving_number;
-    }
-
-    auto run_solving = [&context,
-                        &semaphore,
-                        &search_time,
-                        &parameters,
-                        &ep,
-                        &ep_m,
-                        depth,
-                        this](const unsigned rank) {
-      semaphore.acquire();
-      try {
+      run_adaptive_searches<Route, LocalSearch>(_input,
+                                                parameters,
+                                                nb_searches,
+                                                depth,
+                                                std::max(nb_threads, 1u),
+                                                timeout,
+                                                context);
+    } else {
+      const auto actual_nb_threads =
+        std::min(nb_searches, std::max(nb_threads, 1u));
+      const unsigned ls_nb_threads = nb_threads / actual_nb_threads;
+
+      auto run_solving = [&context,
+                          &parameters,
+                          depth,
+                          ls_nb_threads,
+                          this](const std::size_t rank) {
         run_single_search<Route, LocalSearch>(_input,
                                               parameters[rank],
                                               rank,
                                               depth,
-                                              search_time,
+                                              ls_nb_threads,
                                               context);
-      } catch (...) {
-        const std::scoped_lock<std::mutex> lock(ep_m);
-        ep = std::current_exception();
-      }
-      semaphore.release();
-    };
-
-    std::vector<std::thread> solving_threads;
-    solving_threads.reserve(nb_searches);
-
-    for (unsigned i = 0; i < nb_searches; ++i) {
-      solving_threads.emplace_back(run_solving, i);
-    }
-
-    for (auto& t : solving_threads) {
-      t.join();
-    }
+      };
 
-    if (ep != nullptr) {
-      std::rethrow_exception(ep);
+      _input.thread_pool().parallel_for(nb_searches,
+                                        run_solving,
+                                        actual_nb_threads);
     }
 
     auto best_indic = std::min_element(context.sol_indicators.cbegin(),
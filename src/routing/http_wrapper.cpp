@@ -7,6 +7,13 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <utility>
 
 #include <asio.hpp>
@@ -20,102 +27,373 @@ namespace vroom::routing {
 
 const std::string HttpWrapper::HTTPS_PORT = "443";
 
-HttpWrapper::HttpWrapper(const std::string& profile,
-                         Server server,
-                         std::string matrix_service,
-                         std::string matrix_durations_key,
-                         std::string matrix_distances_key,
-                         std::string route_service,
-                         std::string routing_args)
-  : Wrapper(profile),
-    _server(std::move(server)),
-    _matrix_service(std::move(matrix_service)),
-    _matrix_durations_key(std::move(matrix_durations_key)),
-    _matrix_distances_key(std::move(matrix_distances_key)),
-    _route_service(std::move(route_service)),
-    _routing_args(std::move(routing_args)) {
+namespace {
+
+// Initial size for buffers used to read responses, large enough for
+// most route responses.
+constexpr std::size_t RESPONSE_BUFFER_SIZE = 64 * 1024;
+
+bool is_eof(const std::error_code& error) {
+  return error == asio::error::eof ||
+         error == asio::ssl::error::stream_truncated;
 }
 
-void set_response(auto& s, std::string& response) {
-  char buf[512]; // NOLINT
-  std::error_code error;
-  for (;;) {
-    const std::size_t len = s.read_some(asio::buffer(buf), error);
-    response.append(buf, len); // NOLINT
-    if (error == asio::error::eof) {
-      // Connection closed cleanly.
-      break;
-    }
+// Value for header with lower-case name in lower-case headers.
+std::optional<std::string> get_header(const std::string& headers,
+                                      const std::string& name) {
+  const auto start = headers.find("\r\n" + name + ":");
+  if (start == std::string::npos) {
+    return std::nullopt;
+  }
+
+  auto value_start = start + name.size() + 3;
+  auto value_end = headers.find("\r\n", value_start);
+  if (value_end == std::string::npos) {
+    value_end = headers.size();
+  }
+  while (value_start < value_end && headers[value_start] == ' ') {
+    ++value_start;
+  }
+  while (value_end > value_start && headers[value_end - 1] == ' ') {
+    --value_end;
+  }
+
+  return headers.substr(value_start, value_end - value_start);
+}
+
+} // namespace
+
+struct HttpConnection {
+  std::optional<tcp::socket> socket;
+  std::optional<asio::ssl::stream<tcp::socket>> ssl_stream;
+
+  // Preallocated buffers reused across requests on this connection.
+  std::vector<char> chunk;
+  std::string data;
+
+  HttpConnection() : chunk(RESPONSE_BUFFER_SIZE) {
+    data.reserve(RESPONSE_BUFFER_SIZE);
+  }
+
+  // Read available bytes into data, returning false on end of
+  // stream.
+  template <class Stream> bool read_more(Stream& s) {
+    std::error_code error;
+    const std::size_t len = s.read_some(asio::buffer(chunk), error);
+    data.append(chunk.data(), len);
     if (error) {
+      if (is_eof(error)) {
+        return len > 0;
+      }
       throw std::system_error(error);
     }
+    return true;
   }
-}
 
-std::string get_json(const std::string& response) {
-  // Removing headers.
-  auto start = response.find('{');
-  if (start == std::string::npos) {
-    throw RoutingException("Invalid routing response: " + response);
+  template <class Stream> void read_at_least(Stream& s, std::size_t size) {
+    while (data.size() < size) {
+      if (!read_more(s)) {
+        throw std::system_error(asio::error::eof);
+      }
+    }
   }
-  auto end = response.rfind('}');
-  if (end == std::string::npos) {
-    throw RoutingException("Invalid routing response: " + response);
+
+  // Return position of the end of the line starting at pos.
+  template <class Stream> std::size_t read_line(Stream& s, std::size_t pos) {
+    auto end = data.find("\r\n", pos);
+    while (end == std::string::npos) {
+      if (!read_more(s)) {
+        throw std::system_error(asio::error::eof);
+      }
+      end = data.find("\r\n", pos);
+    }
+    return end;
   }
 
-  return response.substr(start, end - start + 1);
-}
+  // Send query and return response body, reading based on
+  // Content-Length or chunked encoding so that the connection can be
+  // reused when keep_alive is set.
+  template <class Stream>
+  std::string exchange(Stream& s, const std::string& query, bool& keep_alive) {
+    asio::write(s, asio::buffer(query));
+
+    data.clear();
+    auto headers_end = data.find("\r\n\r\n");
+    while (headers_end == std::string::npos) {
+      if (!read_more(s)) {
+        throw std::system_error(asio::error::eof);
+      }
+      headers_end = data.find("\r\n\r\n");
+    }
 
-std::string HttpWrapper::send_then_receive(const std::string& query) const {
-  std::string response;
+    std::string headers = data.substr(0, headers_end + 2);
+    std::ranges::transform(headers, headers.begin(), [](unsigned char c) {
+      return std::tolower(c);
+    });
+    const auto body_start = headers_end + 4;
+
+    const auto connection = get_header(headers, "connection");
+    keep_alive = headers.starts_with("http/1.1")
+                   ? (connection != "close")
+                   : (connection == "keep-alive");
+
+    std::string body;
+    if (get_header(headers, "transfer-encoding") == "chunked") {
+      std::size_t pos = body_start;
+      while (true) {
+        const auto size_end = read_line(s, pos);
+        const auto size = std::stoul(data.substr(pos, size_end - pos),
+                                     nullptr,
+                                     16);
+        pos = size_end + 2;
+        if (size == 0) {
+          // Skip trailers up to final empty line.
+          for (auto end = read_line(s, pos); end != pos;
+               end = read_line(s, pos)) {
+            pos = end + 2;
+          }
+          break;
+        }
+        read_at_least(s, pos + size + 2);
+        body.append(data, pos, size);
+        pos += size + 2;
+      }
+    } else if (const auto length = get_header(headers, "content-length");
+               length.has_value()) {
+      const auto size = std::stoul(length.value());
+      read_at_least(s, body_start + size);
+      body = data.substr(body_start, size);
+    } else {
+      // Body delimited by connection close.
+      while (read_more(s)) {
+      }
+      keep_alive = false;
+      body = data.substr(body_start);
+    }
 
-  try {
-    asio::io_context io_context;
+    return body;
+  }
 
-    tcp::resolver r(io_context);
+  std::string exchange(const std::string& query, bool& keep_alive) {
+    return ssl_stream.has_value() ? exchange(*ssl_stream, query, keep_alive)
+                                  : exchange(*socket, query, keep_alive);
+  }
+};
 
-    tcp::socket s(io_context);
-    asio::connect(s, r.resolve(_server.host, _server.port));
+class HttpConnectionPool {
+private:
+  const std::string _host;
+  const std::string _port;
+  const bool _use_ssl;
+
+  asio::io_context _io_context;
+  std::optional<asio::ssl::context> _ssl_context;
+
+  std::mutex _pool_m;
+  std::condition_variable _pool_cv;
+  unsigned _nb_active{0};
+  std::vector<std::unique_ptr<HttpConnection>> _idle;
+  std::optional<tcp::resolver::results_type> _endpoints;
+  SSL_SESSION* _ssl_session{nullptr};
+
+  // Wait for a free slot, then return an idle connection if any.
+  std::unique_ptr<HttpConnection> acquire() {
+    std::unique_lock<std::mutex> lock(_pool_m);
+    _pool_cv.wait(lock, [this] {
+      return _nb_active < MAX_HTTP_CONNECTIONS_PER_SERVER;
+    });
+    ++_nb_active;
+
+    if (_idle.empty()) {
+      return nullptr;
+    }
+    auto connection = std::move(_idle.back());
+    _idle.pop_back();
+    return connection;
+  }
 
-    asio::write(s, asio::buffer(query));
+  // Free slot, keeping connection for later use if any.
+  void release(std::unique_ptr<HttpConnection>&& connection) {
+    {
+      const std::scoped_lock<std::mutex> lock(_pool_m);
+      --_nb_active;
+      if (connection != nullptr) {
+        _idle.push_back(std::move(connection));
+      }
+    }
+    _pool_cv.notify_one();
+  }
+
+  tcp::resolver::results_type get_endpoints() {
+    {
+      const std::scoped_lock<std::mutex> lock(_pool_m);
+      if (_endpoints.has_value()) {
+        return _endpoints.value();
+      }
+    }
 
-    set_response(s, response);
-  } catch (std::system_error&) {
-    throw RoutingException("Failed to connect to " + _server.host + ":" +
-                           _server.port);
+    tcp::resolver r(_io_context);
+    auto endpoints = r.resolve(_host, _port);
+
+    const std::scoped_lock<std::mutex> lock(_pool_m);
+    _endpoints = endpoints;
+    return endpoints;
   }
 
-  return get_json(response);
-}
+  void clear_endpoints() {
+    const std::scoped_lock<std::mutex> lock(_pool_m);
+    _endpoints.reset();
+  }
+
+  std::unique_ptr<HttpConnection> connect() {
+    auto connection = std::make_unique<HttpConnection>();
+    const auto endpoints = get_endpoints();
+
+    if (!_use_ssl) {
+      connection->socket.emplace(_io_context);
+      asio::connect(connection->socket.value(), endpoints);
+      return connection;
+    }
 
-std::string HttpWrapper::ssl_send_then_receive(const std::string& query) const {
-  std::string response;
+    auto& ssl_stream = connection->ssl_stream.emplace(_io_context,
+                                                      _ssl_context.value());
+    asio::connect(ssl_stream.lowest_layer(), endpoints);
 
-  try {
-    asio::io_context io_context;
+    {
+      // Resume previous TLS session if any to save a full handshake.
+      const std::scoped_lock<std::mutex> lock(_pool_m);
+      if (_ssl_session != nullptr) {
+        SSL_set_session(ssl_stream.native_handle(), _ssl_session);
+      }
+    }
 
-    asio::ssl::context ctx(asio::ssl::context::method::sslv23_client);
-    asio::ssl::stream<asio::ip::tcp::socket> ssock(io_context, ctx);
+    ssl_stream.handshake(asio::ssl::stream_base::handshake_type::client);
+
+    if (SSL_session_reused(ssl_stream.native_handle()) == 0) {
+      SSL_SESSION* session = SSL_get1_session(ssl_stream.native_handle());
+      const std::scoped_lock<std::mutex> lock(_pool_m);
+      if (_ssl_session != nullptr) {
+        SSL_SESSION_free(_ssl_session);
+      }
+      _ssl_session = session;
+    }
 
-    tcp::resolver r(io_context);
+    return connection;
+  }
 
-    asio::connect(ssock.lowest_layer(), r.resolve(_server.host, _server.port));
-    ssock.handshake(asio::ssl::stream_base::handshake_type::client);
+public:
+  HttpConnectionPool(std::string host, std::string port, bool use_ssl)
+    : _host(std::move(host)), _port(std::move(port)), _use_ssl(use_ssl) {
+    if (_use_ssl) {
+      _ssl_context.emplace(asio::ssl::context::method::sslv23_client);
+    }
+  }
 
-    asio::write(ssock, asio::buffer(query));
+  HttpConnectionPool(const HttpConnectionPool&) = delete;
+  HttpConnectionPool& operator=(const HttpConnectionPool&) = delete;
 
-    set_response(ssock, response);
-  } catch (std::system_error&) {
-    throw RoutingException("Failed to connect to " + _server.host + ":" +
-                           _server.port);
+  ~HttpConnectionPool() {
+    // Connections have to be closed before their io_context.
+    _idle.clear();
+    if (_ssl_session != nullptr) {
+      SSL_SESSION_free(_ssl_session);
+    }
   }
 
-  return get_json(response);
+  std::string run_query(const std::string& query) {
+    auto connection = acquire();
+    bool reused = (connection != nullptr);
+
+    while (true) {
+      try {
+        if (connection == nullptr) {
+          connection = connect();
+        }
+
+        bool keep_alive = false;
+        std::string body = connection->exchange(query, keep_alive);
+        if (!keep_alive) {
+          connection.reset();
+        }
+        release(std::move(connection));
+
+        return body;
+      } catch (const std::system_error&) {
+        connection.reset();
+        if (reused) {
+          // Idle connection may have been closed by server in the
+          // meantime, retry once on a new one.
+          reused = false;
+          continue;
+        }
+        clear_endpoints();
+        release(nullptr);
+        throw RoutingException("Failed to connect to " + _host + ":" +
+                               _port);
+      } catch (const std::logic_error&) {
+        // Raised when parsing invalid sizes.
+        release(nullptr);
+        throw RoutingException("Invalid routing response.");
+      }
+    }
+  }
+};
+
+namespace {
+
+// Connections are pooled per server, across all wrappers.
+std::shared_ptr<HttpConnectionPool> get_pool(const Server& server,
+                                             bool use_ssl) {
+  static std::mutex pools_m;
+  static std::unordered_map<std::string, std::weak_ptr<HttpConnectionPool>>
+    pools;
+
+  const std::scoped_lock<std::mutex> lock(pools_m);
+  auto& weak_pool = pools[server.host + ":" + server.port];
+  auto pool = weak_pool.lock();
+  if (pool == nullptr) {
+    pool =
+      std::make_shared<HttpConnectionPool>(server.host, server.port, use_ssl);
+    weak_pool = pool;
+  }
+
+  return pool;
+}
+
+std::string get_json(const std::string& response) {
+  auto start = response.find('{');
+  if (start == std::string::npos) {
+    throw RoutingException("Invalid routing response: " + response);
+  }
+  auto end = response.rfind('}');
+  if (end == std::string::npos) {
+    throw RoutingException("Invalid routing response: " + response);
+  }
+
+  return response.substr(start, end - start + 1);
+}
+
+} // namespace
+
+HttpWrapper::HttpWrapper(const std::string& profile,
+                         Server server,
+                         std::string matrix_service,
+                         std::string matrix_durations_key,
+                         std::string matrix_distances_key,
+                         std::string route_service,
+                         std::string routing_args)
+  : Wrapper(profile),
+    _server(std::move(server)),
+    _matrix_service(std::move(matrix_service)),
+    _matrix_durations_key(std::move(matrix_durations_key)),
+    _matrix_distances_key(std::move(matrix_distances_key)),
+    _route_service(std::move(route_service)),
+    _routing_args(std::move(routing_args)),
+    _pool(get_pool(_server, _server.port == HTTPS_PORT)) {
 }
 
 std::string HttpWrapper::run_query(const std::string& query) const {
-  return (_server.port == HTTPS_PORT) ? ssl_send_then_receive(query)
-                                      : send_then_receive(query);
+  return get_json(_pool->run_query(query));
 }
 
 void HttpWrapper::parse_response(rapidjson::Document& json_result,
@@ -126,40 +404,31 @@ void HttpWrapper::parse_response(rapidjson::Document& json_result,
   }
 }
 
-Matrices HttpWrapper::get_matrices(const std::vector<Location>& locs) const {
-  const std::string query = this->build_query(locs, _matrix_service);
-  const std::string json_string = this->run_query(query);
-
-  // Expected matrix size.
-  const std::size_t m_size = locs.size();
-
-  rapidjson::Document json_result;
-  HttpWrapper::parse_response(json_result, json_string);
-  this->check_response(json_result, locs, _matrix_service);
-
+template <class Set>
+void HttpWrapper::read_matrices(const rapidjson::Document& json_result,
+                                std::size_t nb_rows,
+                                std::size_t nb_cols,
+                                std::vector<unsigned>& nb_unfound_from_loc,
+                                std::vector<unsigned>& nb_unfound_to_loc,
+                                Set&& set) const {
   if (!json_result.HasMember(_matrix_durations_key.c_str())) {
     throw RoutingException("Missing " + _matrix_durations_key + ".");
   }
-  assert(json_result[_matrix_durations_key.c_str()].Size() == m_size);
+  assert(json_result[_matrix_durations_key.c_str()].Size() == nb_rows);
 
   if (!json_result.HasMember(_matrix_distances_key.c_str())) {
     throw RoutingException("Missing " + _matrix_distances_key + ".");
   }
-  assert(json_result[_matrix_distances_key.c_str()].Size() == m_size);
+  assert(json_result[_matrix_distances_key.c_str()].Size() == nb_rows);
 
   // Build matrices while checking for unfound routes ('null' values)
   // to avoid unexpected behavior.
-  Matrices m(m_size);
-
-  std::vector<unsigned> nb_unfound_from_loc(m_size, 0);
-  std::vector<unsigned> nb_unfound_to_loc(m_size, 0);
-
-  for (rapidjson::SizeType i = 0; i < m_size; ++i) {
+  for (rapidjson::SizeType i = 0; i < nb_rows; ++i) {
     const auto& duration_line = json_result[_matrix_durations_key.c_str()][i];
     const auto& distance_line = json_result[_matrix_distances_key.c_str()][i];
-    assert(duration_line.Size() == m_size);
-    assert(distance_line.Size() == m_size);
-    for (rapidjson::SizeType j = 0; j < m_size; ++j) {
+    assert(duration_line.Size() == nb_cols);
+    assert(distance_line.Size() == nb_cols);
+    for (rapidjson::SizeType j = 0; j < nb_cols; ++j) {
       if (duration_value_is_null(duration_line[j]) ||
           distance_value_is_null(distance_line[j])) {
         // No route found between i and j. Just storing info as we
@@ -168,17 +437,89 @@ Matrices HttpWrapper::get_matrices(const std::vector<Location>& locs) const {
         ++nb_unfound_from_loc[i];
         ++nb_unfound_to_loc[j];
       } else {
-        m.durations[i][j] = get_duration_value(duration_line[j]);
-        m.distances[i][j] = get_distance_value(distance_line[j]);
+        set(i,
+            j,
+            get_duration_value(duration_line[j]),
+            get_distance_value(distance_line[j]));
       }
     }
   }
+}
+
+Matrices HttpWrapper::get_matrices(const std::vector<Location>& locs) const {
+  const std::string query = this->build_query(locs, _matrix_service);
+  const std::string json_string = this->run_query(query);
+
+  // Expected matrix size.
+  const std::size_t m_size = locs.size();
+
+  rapidjson::Document json_result;
+  HttpWrapper::parse_response(json_result, json_string);
+  this->check_response(json_result, locs, _matrix_service);
+
+  Matrices m(m_size);
+
+  std::vector<unsigned> nb_unfound_from_loc(m_size, 0);
+  std::vector<unsigned> nb_unfound_to_loc(m_size, 0);
+
+  read_matrices(json_result,
+                m_size,
+                m_size,
+                nb_unfound_from_loc,
+                nb_unfound_to_loc,
+                [&m](std::size_t i,
+                     std::size_t j,
+                     UserDuration duration,
+                     UserDistance distance) {
+                  m.durations[i][j] = duration;
+                  m.distances[i][j] = distance;
+                });
 
   check_unfound(locs, nb_unfound_from_loc, nb_unfound_to_loc);
 
   return m;
 }
 
+MatricesBlock
+HttpWrapper::get_matrices_block(const std::vector<Location>& sources,
+                                const std::vector<Location>& destinations) const {
+  const std::string query = this->build_matrix_query(sources, destinations);
+  const std::string json_string = this->run_query(query);
+
+  rapidjson::Document json_result;
+  HttpWrapper::parse_response(json_result, json_string);
+
+  // Locations in query order, used for error reporting.
+  std::vector<Location> locs(sources);
+  locs.insert(locs.end(), destinations.begin(), destinations.end());
+  this->check_response(json_result, locs, _matrix_service);
+
+  MatricesBlock block(sources.size(), destinations.size());
+
+  std::vector<unsigned> nb_unfound_from_loc(sources.size(), 0);
+  std::vector<unsigned> nb_unfound_to_loc(destinations.size(), 0);
+
+  read_matrices(json_result,
+                sources.size(),
+                destinations.size(),
+                nb_unfound_from_loc,
+                nb_unfound_to_loc,
+                [&block](std::size_t i,
+                         std::size_t j,
+                         UserDuration duration,
+                         UserDistance distance) {
+                  block.duration(i, j) = duration;
+                  block.distance(i, j) = distance;
+                });
+
+  check_unfound(sources,
+                destinations,
+                nb_unfound_from_loc,
+                nb_unfound_to_loc);
+
+  return block;
+}
+
 void HttpWrapper::update_sparse_matrix(const std::vector<Location>& route_locs,
                                        Matrices& m,
                                        std::mutex& matrix_m,
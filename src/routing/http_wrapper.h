@@ -9,6 +9,8 @@ Copyright (c) 2015-2025, Julien Coupey.
 All rights reserved (see LICENSE).
 
 */
+#include <memory>
+
 #include "../include/rapidjson/include/rapidjson/document.h"
 
 #include "routing/wrapper.h"
@@ -17,14 +19,25 @@ All rights reserved (see LICENSE).
 
 namespace vroom::routing {
 
+// Keep-alive connections to a server, shared by all wrappers using
+// that server.
+class HttpConnectionPool;
+
 class HttpWrapper : public Wrapper {
 private:
-  std::string send_then_receive(const std::string& query) const;
-
-  std::string ssl_send_then_receive(const std::string& query) const;
-
   static const std::string HTTPS_PORT;
 
+  // Read matrices values from json_result, calling set(i, j,
+  // duration, distance) for all found routes and counting unfound
+  // ones.
+  template <class Set>
+  void read_matrices(const rapidjson::Document& json_result,
+                     std::size_t nb_rows,
+                     std::size_t nb_cols,
+                     std::vector<unsigned>& nb_unfound_from_loc,
+                     std::vector<unsigned>& nb_unfound_to_loc,
+                     Set&& set) const;
+
 protected:
   const Server _server;
   const std::string _matrix_service;
@@ -33,6 +46,10 @@ protected:
   const std::string _route_service;
   const std::string _routing_args;
 
+private:
+  const std::shared_ptr<HttpConnectionPool> _pool;
+
+protected:
   HttpWrapper(const std::string& profile,
               Server server,
               std::string matrix_service,
@@ -49,12 +66,21 @@ protected:
   virtual std::string build_query(const std::vector<Location>& locations,
                                   const std::string& service) const = 0;
 
+  // Build matrix query from all sources to all destinations.
+  virtual std::string
+  build_matrix_query(const std::vector<Location>& sources,
+                     const std::vector<Location>& destinations) const = 0;
+
   virtual void check_response(const rapidjson::Document& json_result,
                               const std::vector<Location>& locs,
                               const std::string& service) const = 0;
 
   Matrices get_matrices(const std::vector<Location>& locs) const override;
 
+  MatricesBlock
+  get_matrices_block(const std::vector<Location>& sources,
+                     const std::vector<Location>& destinations) const override;
+
   void update_sparse_matrix(const std::vector<Location>& route_locs,
                             Matrices& m,
                             std::mutex& matrix_m,
@@ -57,7 +57,7 @@ void throw_error(osrm::json::Object& result,
   throw RoutingException("libOSRM: " + code + ": " + message);
 }
 
-Matrices LibosrmWrapper::get_matrices(const std::vector<Location>& locs) const {
+osrm::TableParameters get_table_parameters(const std::vector<Location>& locs) {
   osrm::TableParameters params;
   params.annotations = osrm::engine::api::TableParameters::AnnotationsType::All;
 
@@ -70,40 +70,37 @@ Matrices LibosrmWrapper::get_matrices(const std::vector<Location>& locs) const {
     params.radiuses.emplace_back(DEFAULT_LIBOSRM_SNAPPING_RADIUS);
   }
 
-  osrm::json::Object result;
-  osrm::Status status = _osrm.Table(params, result);
-
-  if (status == osrm::Status::Error) {
-    throw_error(result, locs);
-  }
+  return params;
+}
 
+// Read table values from result, calling set(i, j, duration,
+// distance) for all found routes and counting unfound ones.
+template <class Set>
+void read_table(osrm::json::Object& result,
+                std::size_t nb_rows,
+                std::size_t nb_cols,
+                std::vector<unsigned>& nb_unfound_from_loc,
+                std::vector<unsigned>& nb_unfound_to_loc,
+                Set&& set) {
   const auto& durations =
     std::get<osrm::json::Array>(result.values["durations"]);
   const auto& distances =
     std::get<osrm::json::Array>(result.values["distances"]);
 
-  // Expected matrix size.
-  std::size_t m_size = locs.size();
-  assert(durations.values.size() == m_size);
-  assert(distances.values.size() == m_size);
-
-  // Build matrix while checking for unfound routes to avoid
-  // unexpected behavior (OSRM raises 'null').
-  Matrices m(m_size);
+  assert(durations.values.size() == nb_rows);
+  assert(distances.values.size() == nb_rows);
 
-  std::vector<unsigned> nb_unfound_from_loc(m_size, 0);
-  std::vector<unsigned> nb_unfound_to_loc(m_size, 0);
-
-  std::string reason;
-  for (std::size_t i = 0; i < m_size; ++i) {
+  // Check for unfound routes to avoid unexpected behavior (OSRM
+  // raises 'null').
+  for (std::size_t i = 0; i < nb_rows; ++i) {
     const auto& duration_line =
       std::get<osrm::json::Array>(durations.values.at(i));
     const auto& distance_line =
       std::get<osrm::json::Array>(distances.values.at(i));
-    assert(duration_line.values.size() == m_size);
-    assert(distance_line.values.size() == m_size);
+    assert(duration_line.values.size() == nb_cols);
+    assert(distance_line.values.size() == nb_cols);
 
-    for (std::size_t j = 0; j < m_size; ++j) {
+    for (std::size_t j = 0; j < nb_cols; ++j) {
       const auto& duration_el = duration_line.values.at(j);
       const auto& distance_el = distance_line.values.at(j);
       if (std::holds_alternative<osrm::json::Null>(duration_el) ||
@@ -114,19 +111,103 @@ Matrices LibosrmWrapper::get_matrices(const std::vector<Location>& locs) const {
         ++nb_unfound_from_loc[i];
         ++nb_unfound_to_loc[j];
       } else {
-        m.durations[i][j] = utils::round<UserDuration>(
-          std::get<osrm::json::Number>(duration_el).value);
-        m.distances[i][j] = utils::round<UserDistance>(
-          std::get<osrm::json::Number>(distance_el).value);
+        set(i,
+            j,
+            utils::round<UserDuration>(
+              std::get<osrm::json::Number>(duration_el).value),
+            utils::round<UserDistance>(
+              std::get<osrm::json::Number>(distance_el).value));
       }
     }
   }
+}
+
+Matrices LibosrmWrapper::get_matrices(const std::vector<Location>& locs) const {
+  auto params = get_table_parameters(locs);
+
+  osrm::json::Object result;
+  osrm::Status status = _osrm.Table(params, result);
+
+  if (status == osrm::Status::Error) {
+    throw_error(result, locs);
+  }
+
+  // Expected matrix size.
+  std::size_t m_size = locs.size();
+  Matrices m(m_size);
+
+  std::vector<unsigned> nb_unfound_from_loc(m_size, 0);
+  std::vector<unsigned> nb_unfound_to_loc(m_size, 0);
+
+  read_table(result,
+             m_size,
+             m_size,
+             nb_unfound_from_loc,
+             nb_unfound_to_loc,
+             [&m](std::size_t i,
+                  std::size_t j,
+                  UserDuration duration,
+                  UserDistance distance) {
+               m.durations[i][j] = duration;
+               m.distances[i][j] = distance;
+             });
 
   check_unfound(locs, nb_unfound_from_loc, nb_unfound_to_loc);
 
   return m;
 }
 
+MatricesBlock LibosrmWrapper::get_matrices_block(
+  const std::vector<Location>& sources,
+  const std::vector<Location>& destinations) const {
+  // Sources and destinations are listed in that order in table
+  // coordinates.
+  std::vector<Location> locs(sources);
+  locs.insert(locs.end(), destinations.begin(), destinations.end());
+
+  auto params = get_table_parameters(locs);
+  params.sources.reserve(sources.size());
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    params.sources.push_back(i);
+  }
+  params.destinations.reserve(destinations.size());
+  for (std::size_t j = 0; j < destinations.size(); ++j) {
+    params.destinations.push_back(sources.size() + j);
+  }
+
+  osrm::json::Object result;
+  osrm::Status status = _osrm.Table(params, result);
+
+  if (status == osrm::Status::Error) {
+    throw_error(result, locs);
+  }
+
+  MatricesBlock block(sources.size(), destinations.size());
+
+  std::vector<unsigned> nb_unfound_from_loc(sources.size(), 0);
+  std::vector<unsigned> nb_unfound_to_loc(destinations.size(), 0);
+
+  read_table(result,
+             sources.size(),
+             destinations.size(),
+             nb_unfound_from_loc,
+             nb_unfound_to_loc,
+             [&block](std::size_t i,
+                      std::size_t j,
+                      UserDuration duration,
+                      UserDistance distance) {
+               block.duration(i, j) = duration;
+               block.distance(i, j) = distance;
+             });
+
+  check_unfound(sources,
+                destinations,
+                nb_unfound_from_loc,
+                nb_unfound_to_loc);
+
+  return block;
+}
+
 osrm::json::Object LibosrmWrapper::get_route_with_coordinates(
   const std::vector<Location>& locs) const {
   std::vector<osrm::util::Coordinate> coords;
@@ -34,6 +34,10 @@ public:
 
   Matrices get_matrices(const std::vector<Location>& locs) const override;
 
+  MatricesBlock
+  get_matrices_block(const std::vector<Location>& sources,
+                     const std::vector<Location>& destinations) const override;
+
   void update_sparse_matrix(const std::vector<Location>& route_locs,
                             Matrices& m,
                             std::mutex& matrix_m,
@@ -0,0 +1,391 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+#include <unistd.h>
+
+#include "routing/matrix_cache.h"
+
+namespace vroom::routing {
+
+namespace {
+
+// Matches the 6 decimals used for coordinates in routing queries.
+constexpr double COORDINATES_FACTOR = 1e6;
+
+constexpr std::array<char, 8> MAGIC = {'V', 'R', 'O', 'O', 'M', 'M', 'C', 'C'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+template <class U> void write_value(std::ostream& out, U value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(U));
+}
+
+template <class U> U read_value(std::istream& in) {
+  U value{};
+  in.read(reinterpret_cast<char*>(&value), sizeof(U));
+  return value;
+}
+
+template <class T> void write_matrix(std::ostream& out, const Matrix<T>& m) {
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    out.write(reinterpret_cast<const char*>(m[i]), m.size() * sizeof(T));
+  }
+}
+
+template <class T> void read_matrix(std::istream& in, Matrix<T>& m) {
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    in.read(reinterpret_cast<char*>(m[i]), m.size() * sizeof(T));
+  }
+}
+
+// FNV-1a, used for stable file names across builds.
+uint64_t get_hash(const std::string& key) {
+  constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+  constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+  uint64_t hash = FNV_OFFSET;
+  for (const char c : key) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+} // namespace
+
+MatrixCache::Entry::Entry(std::string key,
+                          std::string profile,
+                          std::vector<Coords>&& coordinates,
+                          Matrices&& matrices)
+  : key(std::move(key)),
+    profile(std::move(profile)),
+    coordinates(std::move(coordinates)),
+    matrices(std::move(matrices)) {
+  ranks.reserve(this->coordinates.size());
+  for (Index i = 0; i < this->coordinates.size(); ++i) {
+    ranks.try_emplace(this->coordinates[i], i);
+  }
+}
+
+std::vector<MatrixCache::Coords>
+MatrixCache::get_coordinates(const std::vector<Location>& locs) {
+  std::vector<Coords> coordinates;
+  coordinates.reserve(locs.size());
+
+  for (const auto& loc : locs) {
+    assert(loc.has_coordinates());
+    coordinates.emplace_back(std::llround(loc.lon() * COORDINATES_FACTOR),
+                             std::llround(loc.lat() * COORDINATES_FACTOR));
+  }
+
+  return coordinates;
+}
+
+std::string MatrixCache::get_key(const std::string& profile,
+                                 const std::vector<Coords>& coordinates) {
+  std::string key = profile;
+  key.push_back('\0');
+
+  const auto profile_size = key.size();
+  key.resize(profile_size + coordinates.size() * 2 * sizeof(int64_t));
+  for (std::size_t i = 0; i < coordinates.size(); ++i) {
+    char* target = key.data() + profile_size + i * 2 * sizeof(int64_t);
+    std::memcpy(target, &coordinates[i].first, sizeof(int64_t));
+    std::memcpy(target + sizeof(int64_t),
+                &coordinates[i].second,
+                sizeof(int64_t));
+  }
+
+  return key;
+}
+
+std::string MatrixCache::get_file_path(const std::string& key) const {
+  return (std::filesystem::path(_directory) /
+          std::format("{:016x}.vroomcache", get_hash(key)))
+    .string();
+}
+
+MatrixCache::EntryPtr
+MatrixCache::load(const std::string& key,
+                  const std::string& profile,
+                  const std::vector<Coords>& coordinates) const {
+  std::ifstream in(get_file_path(key), std::ios::binary);
+  if (!in) {
+    return nullptr;
+  }
+
+  std::array<char, MAGIC.size()> magic{};
+  in.read(magic.data(), magic.size());
+  const auto version = read_value<uint32_t>(in);
+  const auto profile_size = read_value<uint32_t>(in);
+  const auto n = read_value<uint64_t>(in);
+  if (!in || magic != MAGIC || version != FORMAT_VERSION ||
+      profile_size != profile.size() || n != coordinates.size()) {
+    return nullptr;
+  }
+
+  std::string file_profile(profile_size, '\0');
+  in.read(file_profile.data(), profile_size);
+
+  std::vector<Coords> file_coordinates(n);
+  for (auto& c : file_coordinates) {
+    c.first = read_value<int64_t>(in);
+    c.second = read_value<int64_t>(in);
+  }
+
+  // Different keys may share the same file name.
+  if (!in || file_profile != profile || file_coordinates != coordinates) {
+    return nullptr;
+  }
+
+  Matrices matrices(n);
+  read_matrix(in, matrices.durations);
+  read_matrix(in, matrices.distances);
+  if (!in) {
+    return nullptr;
+  }
+
+  return std::make_shared<const Entry>(key,
+                                       profile,
+                                       std::move(file_coordinates),
+                                       std::move(matrices));
+}
+
+void MatrixCache::store(const Entry& entry) const {
+  const auto file_path = get_file_path(entry.key);
+
+  // Write to a temporary file first so that concurrent runs never
+  // read partial entries.
+  const auto tmp_path = std::format("{}.{}.{:x}",
+                                    file_path,
+                                    ::getpid(),
+                                    reinterpret_cast<std::uintptr_t>(&entry));
+
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out) {
+      return;
+    }
+
+    out.write(MAGIC.data(), MAGIC.size());
+    write_value<uint32_t>(out, FORMAT_VERSION);
+    write_value<uint32_t>(out, entry.profile.size());
+    write_value<uint64_t>(out, entry.coordinates.size());
+    out.write(entry.profile.data(), entry.profile.size());
+    for (const auto& c : entry.coordinates) {
+      write_value<int64_t>(out, c.first);
+      write_value<int64_t>(out, c.second);
+    }
+    write_matrix(out, entry.matrices.durations);
+    write_matrix(out, entry.matrices.distances);
+
+    if (!out) {
+      out.close();
+      std::error_code ec;
+      std::filesystem::remove(tmp_path, ec);
+      return;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, file_path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp_path, ec);
+  }
+}
+
+MatrixCache::EntryPtr MatrixCache::find(const std::string& key) {
+  const auto search = _by_key.find(key);
+  if (search == _by_key.end()) {
+    return nullptr;
+  }
+
+  // Mark as most recently used.
+  _entries.splice(_entries.begin(), _entries, search->second);
+  return *(search->second);
+}
+
+MatrixCache::EntryPtr
+MatrixCache::find_closest(const std::string& profile,
+                          const std::vector<Coords>& coordinates) const {
+  EntryPtr closest;
+  std::size_t best_overlap = 0;
+
+  for (const auto& entry : _entries) {
+    if (entry->profile != profile) {
+      continue;
+    }
+
+    std::size_t overlap = 0;
+    for (const auto& c : coordinates) {
+      if (entry->ranks.contains(c)) {
+        ++overlap;
+      }
+    }
+
+    if (overlap > best_overlap) {
+      best_overlap = overlap;
+      closest = entry;
+    }
+  }
+
+  // Only worth it if at least half the locations are known.
+  return (2 * best_overlap >= coordinates.size()) ? closest : nullptr;
+}
+
+void MatrixCache::insert(const EntryPtr& entry) {
+  if (_capacity == 0) {
+    return;
+  }
+
+  if (const auto search = _by_key.find(entry->key); search != _by_key.end()) {
+    // Entry concurrently added.
+    _entries.erase(search->second);
+    _by_key.erase(search);
+  }
+
+  _entries.push_front(entry);
+  _by_key.emplace(entry->key, _entries.begin());
+
+  while (_entries.size() > _capacity) {
+    _by_key.erase(_entries.back()->key);
+    _entries.pop_back();
+  }
+}
+
+Matrices MatrixCache::get_matrices(const Wrapper& wrapper,
+                                   utils::ThreadPool& pool,
+                                   const std::vector<Location>& locs,
+                                   std::size_t block_size,
+                                   MatrixCacheStats& stats) {
+  auto coordinates = get_coordinates(locs);
+  auto key = get_key(wrapper.profile, coordinates);
+
+  EntryPtr closest;
+  {
+    const std::scoped_lock<std::mutex> lock(_entries_m);
+    if (const auto entry = find(key); entry != nullptr) {
+      ++stats.hits;
+      return entry->matrices;
+    }
+    closest = find_closest(wrapper.profile, coordinates);
+  }
+
+  if (!_directory.empty()) {
+    if (const auto entry = load(key, wrapper.profile, coordinates);
+        entry != nullptr) {
+      const std::scoped_lock<std::mutex> lock(_entries_m);
+      insert(entry);
+      ++stats.hits;
+      return entry->matrices;
+    }
+  }
+
+  const std::size_t n = locs.size();
+
+  std::optional<Matrices> matrices;
+  bool fetched = true;
+  if (closest == nullptr) {
+    matrices = wrapper.get_tiled_matrices(pool, locs, block_size);
+  } else {
+    // Ranks in closest entry for known locations, or in missing
+    // locations for others.
+    std::vector<Index> ranks(n);
+    std::vector<bool> is_known(n);
+
+    std::vector<Location> known_locs;
+    std::vector<Index> known_ranks;
+    std::vector<Location> missing_locs;
+    std::unordered_map<Coords, Index, CoordsHash> missing_ranks;
+
+    for (Index i = 0; i < n; ++i) {
+      if (const auto search = closest->ranks.find(coordinates[i]);
+          search != closest->ranks.end()) {
+        is_known[i] = true;
+        ranks[i] = search->second;
+        known_ranks.push_back(known_locs.size());
+        known_locs.push_back(locs[i]);
+      } else {
+        const auto [it, inserted] =
+          missing_ranks.try_emplace(coordinates[i], missing_locs.size());
+        if (inserted) {
+          missing_locs.push_back(locs[i]);
+        }
+        ranks[i] = it->second;
+        known_ranks.push_back(0);
+      }
+    }
+
+    // Fetch rows from missing locations and remaining columns to
+    // missing locations. Nothing to fetch if all locations are known
+    // in a different order.
+    fetched = !missing_locs.empty();
+    const auto from_missing =
+      fetched ? wrapper.get_tiled_matrices_block(pool,
+                                                 missing_locs,
+                                                 locs,
+                                                 block_size)
+              : MatricesBlock(0, 0);
+    const auto to_missing =
+      (fetched && !known_locs.empty())
+        ? wrapper.get_tiled_matrices_block(pool,
+                                           known_locs,
+                                           missing_locs,
+                                           block_size)
+        : MatricesBlock(0, 0);
+
+    const auto& cached = closest->matrices;
+    matrices = Matrices(n);
+    for (Index i = 0; i < n; ++i) {
+      for (Index j = 0; j < n; ++j) {
+        if (!is_known[i]) {
+          matrices->durations[i][j] = from_missing.duration(ranks[i], j);
+          matrices->distances[i][j] = from_missing.distance(ranks[i], j);
+        } else if (!is_known[j]) {
+          matrices->durations[i][j] =
+            to_missing.duration(known_ranks[i], ranks[j]);
+          matrices->distances[i][j] =
+            to_missing.distance(known_ranks[i], ranks[j]);
+        } else {
+          matrices->durations[i][j] = cached.durations[ranks[i]][ranks[j]];
+          matrices->distances[i][j] = cached.distances[ranks[i]][ranks[j]];
+        }
+      }
+    }
+  }
+
+  const auto entry = std::make_shared<const Entry>(std::move(key),
+                                                   wrapper.profile,
+                                                   std::move(coordinates),
+                                                   std::move(*matrices));
+
+  if (!_directory.empty()) {
+    store(*entry);
+  }
+
+  const std::scoped_lock<std::mutex> lock(_entries_m);
+  insert(entry);
+  if (closest == nullptr) {
+    ++stats.misses;
+  } else if (fetched) {
+    ++stats.partial_hits;
+  } else {
+    ++stats.hits;
+  }
+
+  return entry->matrices;
+}
+
+} // namespace vroom::routing
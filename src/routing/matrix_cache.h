@@ -0,0 +1,115 @@
+#ifndef MATRIX_CACHE_H
+#define MATRIX_CACHE_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "routing/wrapper.h"
+#include "structures/vroom/solution/computing_times.h"
+
+namespace vroom::routing {
+
+// Cache for matrices computed by routing wrappers, keyed by profile
+// and locations coordinates. Up to capacity entries are kept in
+// memory, least recently used ones being evicted first. If a
+// directory is provided, all computed matrices are also stored there
+// and looked up on memory misses, which allows reusing them across
+// runs.
+//
+// Requests for a set of locations sharing at least half of its
+// coordinates with an entry in memory only fetch missing rows and
+// columns from the routing wrapper.
+class MatrixCache {
+private:
+  // Coordinates rounded to the precision used in routing queries.
+  using Coords = std::pair<int64_t, int64_t>;
+
+  struct CoordsHash {
+    std::size_t operator()(const Coords& c) const {
+      return std::hash<int64_t>()(c.first) ^
+             (std::hash<int64_t>()(c.second) << 1);
+    }
+  };
+
+  struct Entry {
+    std::string key;
+    std::string profile;
+    std::vector<Coords> coordinates;
+    // Rank in coordinates, used for partial hits.
+    std::unordered_map<Coords, Index, CoordsHash> ranks;
+    Matrices matrices;
+
+    Entry(std::string key,
+          std::string profile,
+          std::vector<Coords>&& coordinates,
+          Matrices&& matrices);
+  };
+
+  using EntryPtr = std::shared_ptr<const Entry>;
+
+  const std::size_t _capacity;
+  const std::string _directory;
+
+  std::mutex _entries_m;
+  // Most recently used entries first.
+  std::list<EntryPtr> _entries;
+  std::unordered_map<std::string, std::list<EntryPtr>::iterator> _by_key;
+
+  static std::vector<Coords> get_coordinates(const std::vector<Location>& locs);
+
+  static std::string get_key(const std::string& profile,
+                             const std::vector<Coords>& coordinates);
+
+  std::string get_file_path(const std::string& key) const;
+
+  // Disk store is best-effort: failing to read or write an entry
+  // only means it is not served from the cache.
+  EntryPtr load(const std::string& key,
+                const std::string& profile,
+                const std::vector<Coords>& coordinates) const;
+
+  void store(const Entry& entry) const;
+
+  // Following functions require holding _entries_m.
+  EntryPtr find(const std::string& key);
+
+  EntryPtr find_closest(const std::string& profile,
+                        const std::vector<Coords>& coordinates) const;
+
+  void insert(const EntryPtr& entry);
+
+public:
+  explicit MatrixCache(std::size_t capacity, std::string directory = "")
+    : _capacity(capacity), _directory(std::move(directory)) {
+  }
+
+  // Get matrices for locs from cache or routing wrapper, using
+  // requests split based on block_size (see
+  // Wrapper::get_tiled_matrices). Counters in stats are updated while
+  // holding the cache lock so the same stats may be used across
+  // concurrent calls.
+  Matrices get_matrices(const Wrapper& wrapper,
+                        utils::ThreadPool& pool,
+                        const std::vector<Location>& locs,
+                        std::size_t block_size,
+                        MatrixCacheStats& stats);
+};
+
+} // namespace vroom::routing
+
+#endif
@@ -22,7 +22,8 @@ OrsWrapper::OrsWrapper(const std::string& profile, const Server& server)
 }
 
 std::string OrsWrapper::build_query(const std::vector<Location>& locations,
-                                    const std::string& service) const {
+                                    const std::string& service,
+                                    const std::string& extra_body) const {
   // Adding locations.
   std::string body = "{\"";
   if (service == "directions") {
@@ -42,22 +43,52 @@ std::string OrsWrapper::build_query(const std::vector<Location>& locations,
     assert(service == _matrix_service);
     body += R"(,"metrics":["duration","distance"])";
   }
+  body += extra_body;
   body += "}";
 
   // Building query for ORS
   std::string query = "POST /" + _server.path + service + "/" + profile;
 
-  query += " HTTP/1.0\r\n";
+  query += " HTTP/1.1\r\n";
   query += "Accept: */*\r\n";
   query += "Content-Type: application/json\r\n";
   query += std::format("Content-Length: {}\r\n", body.size());
   query += "Host: " + _server.host + ":" + _server.port + "\r\n";
-  query += "Connection: close\r\n";
+  query += "Connection: keep-alive\r\n";
   query += "\r\n" + body;
 
   return query;
 }
 
+std::string OrsWrapper::build_query(const std::vector<Location>& locations,
+                                    const std::string& service) const {
+  return build_query(locations, service, "");
+}
+
+std::string
+OrsWrapper::build_matrix_query(const std::vector<Location>& sources,
+                               const std::vector<Location>& destinations) const {
+  // Sources and destinations are listed in that order in query
+  // locations.
+  std::vector<Location> locations(sources);
+  locations.insert(locations.end(), destinations.begin(), destinations.end());
+
+  std::string indices = R"(,"sources":[)";
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    indices += std::format("{},", i);
+  }
+  indices.pop_back();
+
+  indices += R"(],"destinations":[)";
+  for (std::size_t j = 0; j < destinations.size(); ++j) {
+    indices += std::format("{},", sources.size() + j);
+  }
+  indices.pop_back();
+  indices += "]";
+
+  return build_query(locations, _matrix_service, indices);
+}
+
 void OrsWrapper::check_response(const rapidjson::Document& json_result,
                                 const std::vector<Location>&,
                                 const std::string&) const {
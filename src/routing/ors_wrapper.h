@@ -16,9 +16,17 @@ namespace vroom::routing {
 
 class OrsWrapper : public HttpWrapper {
 private:
+  std::string build_query(const std::vector<Location>& locations,
+                          const std::string& service,
+                          const std::string& extra_body) const;
+
   std::string build_query(const std::vector<Location>& locations,
                           const std::string& service) const override;
 
+  std::string
+  build_matrix_query(const std::vector<Location>& sources,
+                     const std::vector<Location>& destinations) const override;
+
   void check_response(const rapidjson::Document& json_result,
                       const std::vector<Location>& locs,
                       const std::string& service) const override;
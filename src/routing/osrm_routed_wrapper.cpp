@@ -25,7 +25,8 @@ OsrmRoutedWrapper::OsrmRoutedWrapper(const std::string& profile,
 
 std::string
 OsrmRoutedWrapper::build_query(const std::vector<Location>& locations,
-                               const std::string& service) const {
+                               const std::string& service,
+                               const std::string& extra_args) const {
   // Building query for osrm-routed
   std::string query = "GET /" + _server.path + service;
 
@@ -52,16 +53,46 @@ OsrmRoutedWrapper::build_query(const std::vector<Location>& locations,
     assert(service == _matrix_service);
     query += "?annotations=duration,distance";
   }
+  query += extra_args;
   query += "&" + radiuses;
 
   query += " HTTP/1.1\r\n";
   query += "Host: " + _server.host + "\r\n";
   query += "Accept: */*\r\n";
-  query += "Connection: close\r\n\r\n";
+  query += "Connection: keep-alive\r\n\r\n";
 
   return query;
 }
 
+std::string
+OsrmRoutedWrapper::build_query(const std::vector<Location>& locations,
+                               const std::string& service) const {
+  return build_query(locations, service, "");
+}
+
+std::string OsrmRoutedWrapper::build_matrix_query(
+  const std::vector<Location>& sources,
+  const std::vector<Location>& destinations) const {
+  // Sources and destinations are listed in that order in query
+  // coordinates.
+  std::vector<Location> locations(sources);
+  locations.insert(locations.end(), destinations.begin(), destinations.end());
+
+  std::string indices = "&sources=";
+  for (std::size_t i = 0; i < sources.size(); ++i) {
+    indices += std::format("{};", i);
+  }
+  indices.pop_back();
+
+  indices += "&destinations=";
+  for (std::size_t j = 0; j < destinations.size(); ++j) {
+    indices += std::format("{};", sources.size() + j);
+  }
+  indices.pop_back();
+
+  return build_query(locations, _matrix_service, indices);
+}
+
 void OsrmRoutedWrapper::check_response(const rapidjson::Document& json_result,
                                        const std::vector<Location>& locs,
                                        const std::string&) const {
@@ -29,28 +29,36 @@ ValhallaWrapper::ValhallaWrapper(const std::string& profile,
                 R"("directions_type":"none")") {
 }
 
-std::string ValhallaWrapper::get_matrix_query(
-  const std::vector<Location>& locations) const {
+std::string
+ValhallaWrapper::get_matrix_query(const std::vector<Location>& sources,
+                                  const std::vector<Location>& targets) const {
   // Building matrix query for Valhalla.
   std::string query = "GET /" + _server.path + _matrix_service + "?json=";
 
   // List locations.
-  std::string all_locations;
-  for (auto const& location : locations) {
-    all_locations += std::format(R"({{"lon":{:.6f},"lat":{:.6f}}},)",
-                                 location.lon(),
-                                 location.lat());
-  }
-  all_locations.pop_back(); // Remove trailing ','.
+  auto list_locations = [](const std::vector<Location>& locations) {
+    std::string list;
+    for (auto const& location : locations) {
+      list += std::format(R"({{"lon":{:.6f},"lat":{:.6f}}},)",
+                          location.lon(),
+                          location.lat());
+    }
+    list.pop_back(); // Remove trailing ','.
+    return list;
+  };
 
-  query += "{\"sources\":[" + all_locations;
-  query += "],\"targets\":[" + all_locations;
+  const std::string source_locations = list_locations(sources);
+  const std::string target_locations =
+    (&sources == &targets) ? source_locations : list_locations(targets);
+
+  query += "{\"sources\":[" + source_locations;
+  query += "],\"targets\":[" + target_locations;
   query += R"(],"costing":")" + profile + "\"}";
 
   query += " HTTP/1.1\r\n";
   query += "Host: " + _server.host + "\r\n";
   query += "Accept: */*\r\n";
-  query += "Connection: Close\r\n\r\n";
+  query += "Connection: keep-alive\r\n\r\n";
 
   return query;
 }
@@ -75,7 +83,7 @@ ValhallaWrapper::get_route_query(const std::vector<Location>& locations) const {
   query += " HTTP/1.1\r\n";
   query += "Host: " + _server.host + "\r\n";
   query += "Accept: */*\r\n";
-  query += "Connection: Close\r\n\r\n";
+  query += "Connection: keep-alive\r\n\r\n";
 
   return query;
 }
@@ -84,10 +92,16 @@ std::string ValhallaWrapper::build_query(const std::vector<Location>& locations,
                                          const std::string& service) const {
   assert(service == _matrix_service || service == _route_service);
 
-  return (service == _matrix_service) ? get_matrix_query(locations)
+  return (service == _matrix_service) ? get_matrix_query(locations, locations)
                                       : get_route_query(locations);
 }
 
+std::string ValhallaWrapper::build_matrix_query(
+  const std::vector<Location>& sources,
+  const std::vector<Location>& destinations) const {
+  return get_matrix_query(sources, destinations);
+}
+
 void ValhallaWrapper::check_response(const rapidjson::Document& json_result,
                                      const std::vector<Location>&,
                                      const std::string& service) const {
@@ -16,13 +16,18 @@ namespace vroom::routing {
 
 class ValhallaWrapper : public HttpWrapper {
 private:
-  std::string get_matrix_query(const std::vector<Location>& locations) const;
+  std::string get_matrix_query(const std::vector<Location>& sources,
+                               const std::vector<Location>& targets) const;
 
   std::string get_route_query(const std::vector<Location>& locations) const;
 
   std::string build_query(const std::vector<Location>& locations,
                           const std::string& service) const override;
 
+  std::string
+  build_matrix_query(const std::vector<Location>& sources,
+                     const std::vector<Location>& destinations) const override;
+
   void check_response(const rapidjson::Document& json_result,
                       const std::vector<Location>& locs,
                       const std::string& service) const override;
@@ -10,8 +10,8 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <algorithm>
 #include <mutex>
-#include <thread>
 #include <vector>
 
 #include "structures/generic/matrix.h"
@@ -20,6 +20,7 @@ All rights reserved (see LICENSE).
 #include "structures/vroom/solution/route.h"
 #include "structures/vroom/vehicle.h"
 #include "utils/exception.h"
+#include "utils/thread_pool.h"
 
 namespace vroom::routing {
 
@@ -30,80 +31,143 @@ public:
 
   virtual Matrices get_matrices(const std::vector<Location>& locs) const = 0;
 
+  // Matrices from all sources to all destinations. Default
+  // implementation requests full matrices for all involved locations
+  // then extracts the relevant block.
+  virtual MatricesBlock
+  get_matrices_block(const std::vector<Location>& sources,
+                     const std::vector<Location>& destinations) const {
+    std::vector<Location> locs(sources);
+    locs.insert(locs.end(), destinations.begin(), destinations.end());
+
+    const auto m = get_matrices(locs);
+
+    MatricesBlock block(sources.size(), destinations.size());
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+      for (std::size_t j = 0; j < destinations.size(); ++j) {
+        block.duration(i, j) = m.durations[i][sources.size() + j];
+        block.distance(i, j) = m.distances[i][sources.size() + j];
+      }
+    }
+
+    return block;
+  }
+
+  // Same as get_matrices, splitting requests in blocks of at most
+  // block_size sources and destinations that are run concurrently. A
+  // block_size of 0 means no splitting.
+  Matrices get_tiled_matrices(utils::ThreadPool& pool,
+                              const std::vector<Location>& locs,
+                              std::size_t block_size) const {
+    if (block_size == 0 || locs.size() <= block_size) {
+      return get_matrices(locs);
+    }
+
+    Matrices m(locs.size());
+    run_on_tiles(pool,
+                 locs,
+                 locs,
+                 block_size,
+                 [&m](std::size_t i,
+                      std::size_t j,
+                      UserDuration duration,
+                      UserDistance distance) {
+                   m.durations[i][j] = duration;
+                   m.distances[i][j] = distance;
+                 });
+
+    return m;
+  }
+
+  // Same as get_matrices_block with splitting as above.
+  MatricesBlock
+  get_tiled_matrices_block(utils::ThreadPool& pool,
+                           const std::vector<Location>& sources,
+                           const std::vector<Location>& destinations,
+                           std::size_t block_size) const {
+    if (block_size == 0 ||
+        (sources.size() <= block_size && destinations.size() <= block_size)) {
+      return get_matrices_block(sources, destinations);
+    }
+
+    MatricesBlock m(sources.size(), destinations.size());
+    run_on_tiles(pool,
+                 sources,
+                 destinations,
+                 block_size,
+                 [&m](std::size_t i,
+                      std::size_t j,
+                      UserDuration duration,
+                      UserDistance distance) {
+                   m.duration(i, j) = duration;
+                   m.distance(i, j) = distance;
+                 });
+
+    return m;
+  }
+
   Matrices
-  get_sparse_matrices(const std::vector<Location>& locs,
+  get_sparse_matrices(utils::ThreadPool& pool,
+                      const std::vector<Location>& locs,
                       const std::vector<Vehicle>& vehicles,
                       const std::vector<Job>& jobs,
                       std::vector<std::string>& vehicles_geometry) const {
     const std::size_t m_size = locs.size();
     Matrices m(m_size);
 
-    std::exception_ptr ep = nullptr;
-    std::mutex ep_m;
     std::mutex matrix_m;
 
     auto run_on_vehicle_at_rank =
-      [this, &vehicles, &jobs, &matrix_m, &m, &vehicles_geometry, &ep_m, &ep](
+      [this, &vehicles, &jobs, &matrix_m, &m, &vehicles_geometry](
         Index v_rank) {
-        try {
-          const Vehicle& v = vehicles[v_rank];
-
-          std::vector<Location> route_locs;
-          route_locs.reserve(v.steps.size());
-
-          bool has_job_steps = false;
-          for (const auto& step : v.steps) {
-            switch (step.type) {
-              using enum STEP_TYPE;
-            case START:
-              if (v.has_start()) {
-                route_locs.push_back(v.start.value());
-              }
-              break;
-            case END:
-              if (v.has_end()) {
-                route_locs.push_back(v.end.value());
-              }
-              break;
-            case BREAK:
-              break;
-            case JOB:
-              has_job_steps = true;
-              route_locs.push_back(jobs[step.rank].location);
-              break;
+        const Vehicle& v = vehicles[v_rank];
+
+        std::vector<Location> route_locs;
+        route_locs.reserve(v.steps.size());
+
+        bool has_job_steps = false;
+        for (const auto& step : v.steps) {
+          switch (step.type) {
+            using enum STEP_TYPE;
+          case START:
+            if (v.has_start()) {
+              route_locs.push_back(v.start.value());
             }
+            break;
+          case END:
+            if (v.has_end()) {
+              route_locs.push_back(v.end.value());
+            }
+            break;
+          case BREAK:
+            break;
+          case JOB:
+            has_job_steps = true;
+            route_locs.push_back(jobs[step.rank].location);
+            break;
           }
+        }
 
-          if (has_job_steps) {
-            assert(route_locs.size() >= 2);
+        if (has_job_steps) {
+          assert(route_locs.size() >= 2);
 
-            this->update_sparse_matrix(route_locs,
-                                       m,
-                                       matrix_m,
-                                       vehicles_geometry[v_rank]);
-          }
-        } catch (...) {
-          const std::scoped_lock<std::mutex> lock(ep_m);
-          ep = std::current_exception();
+          this->update_sparse_matrix(route_locs,
+                                     m,
+                                     matrix_m,
+                                     vehicles_geometry[v_rank]);
         }
       };
 
-    std::vector<std::thread> vehicles_threads;
-    vehicles_threads.reserve(vehicles.size());
-
+    std::vector<Index> v_ranks;
     for (Index v_rank = 0; v_rank < vehicles.size(); ++v_rank) {
       if (vehicles[v_rank].profile == this->profile) {
-        vehicles_threads.emplace_back(run_on_vehicle_at_rank, v_rank);
+        v_ranks.push_back(v_rank);
       }
     }
 
-    for (auto& t : vehicles_threads) {
-      t.join();
-    }
-
-    if (ep != nullptr) {
-      std::rethrow_exception(ep);
-    }
+    pool.parallel_for(v_ranks.size(), [&](std::size_t i) {
+      run_on_vehicle_at_rank(v_ranks[i]);
+    });
 
     return m;
   };
@@ -123,6 +187,47 @@ protected:
   explicit Wrapper(std::string profile) : profile(std::move(profile)) {
   }
 
+  // Request all blocks of at most block_size sources and
+  // destinations concurrently, calling set(i, j, duration, distance)
+  // with ranks in sources and destinations. Blocks are disjoint so no
+  // locking is required in set.
+  template <class Set>
+  void run_on_tiles(utils::ThreadPool& pool,
+                    const std::vector<Location>& sources,
+                    const std::vector<Location>& destinations,
+                    std::size_t block_size,
+                    Set&& set) const {
+    assert(block_size > 0);
+    const auto nb_row_blocks = (sources.size() + block_size - 1) / block_size;
+    const auto nb_col_blocks =
+      (destinations.size() + block_size - 1) / block_size;
+
+    pool.parallel_for(nb_row_blocks * nb_col_blocks, [&](std::size_t b) {
+      const auto row_begin = (b / nb_col_blocks) * block_size;
+      const auto row_end = std::min(row_begin + block_size, sources.size());
+      const auto col_begin = (b % nb_col_blocks) * block_size;
+      const auto col_end =
+        std::min(col_begin + block_size, destinations.size());
+
+      const std::vector<Location> block_sources(sources.begin() + row_begin,
+                                                sources.begin() + row_end);
+      const std::vector<Location>
+        block_destinations(destinations.begin() + col_begin,
+                           destinations.begin() + col_end);
+
+      const auto block = get_matrices_block(block_sources, block_destinations);
+
+      for (std::size_t i = 0; i < block.nb_rows; ++i) {
+        for (std::size_t j = 0; j < block.nb_cols; ++j) {
+          set(row_begin + i,
+              col_begin + j,
+              block.duration(i, j),
+              block.distance(i, j));
+        }
+      }
+    });
+  }
+
   static void check_unfound(const std::vector<Location>& locs,
                             const std::vector<unsigned>& nb_unfound_from_loc,
                             const std::vector<unsigned>& nb_unfound_to_loc) {
@@ -153,6 +258,44 @@ protected:
       throw RoutingException(error_msg);
     }
   }
+
+  // Same as above for matrices from sources to destinations.
+
+  static void check_unfound(const std::vector<Location>& sources,
+                            const std::vector<Location>& destinations,
+                            const std::vector<unsigned>& nb_unfound_from_loc,
+                            const std::vector<unsigned>& nb_unfound_to_loc) {
+    assert(nb_unfound_from_loc.size() == sources.size());
+    assert(nb_unfound_to_loc.size() == destinations.size());
+    unsigned max_unfound_routes_for_a_loc = 0;
+    const Location* error_loc = nullptr;
+    std::string error_direction;
+    // Finding the "worst" location for unfound routes.
+    for (unsigned i = 0; i < nb_unfound_from_loc.size(); ++i) {
+      if (nb_unfound_from_loc[i] > max_unfound_routes_for_a_loc) {
+        max_unfound_routes_for_a_loc = nb_unfound_from_loc[i];
+        error_loc = &sources[i];
+        error_direction = "from ";
+      }
+    }
+    for (unsigned j = 0; j < nb_unfound_to_loc.size(); ++j) {
+      if (nb_unfound_to_loc[j] > max_unfound_routes_for_a_loc) {
+        max_unfound_routes_for_a_loc = nb_unfound_to_loc[j];
+        error_loc = &destinations[j];
+        error_direction = "to ";
+      }
+    }
+    if (max_unfound_routes_for_a_loc > 0) {
+      assert(error_loc != nullptr);
+      std::string error_msg = "Unfound route(s) ";
+      error_msg += error_direction;
+      error_msg += std::format("location [{:.6f},{:.6f}]",
+                               error_loc->lon(),
+                               error_loc->lat());
+
+      throw RoutingException(error_msg);
+    }
+  }
 };
 
 } // namespace vroom::routing
@@ -25,11 +25,15 @@ struct CLArgs {
   // Listing command-line options.
   Servers servers;                           // -a and -p
   bool check;                                // -c
+  std::optional<unsigned> coords_precision;  // --coordinates-precision
   std::vector<HeuristicParameters> h_params; // -e
   bool apply_TSPFix;                         // -f
   bool geometry;                             // -g
   std::string input_file;                    // -i
   Timeout timeout;                           // -l
+  std::vector<std::string> matrix_files;     // -m
+  std::string matrix_cache_dir;              // --matrix-cache
+  std::size_t matrix_block_size;             // --matrix-block-size
   std::string output_file;                   // -o
   ROUTER router;                             // -r
   std::string input;                         // cl arg
@@ -10,6 +10,7 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <memory>
 #include <vector>
 
 #include "structures/typedefs.h"
@@ -20,6 +21,23 @@ template <class T> class Matrix {
 
   std::size_t n;
   std::vector<T> data;
+  // Optional externally owned storage (e.g. a memory-mapped file)
+  // used instead of data. It is never written to: copies share it for
+  // reading and values are copied to data upon first non-const
+  // access.
+  std::shared_ptr<const T> external_data;
+
+  T* values() {
+    if (external_data) {
+      data.assign(external_data.get(), external_data.get() + n * n);
+      external_data.reset();
+    }
+    return data.data();
+  }
+
+  const T* values() const {
+    return external_data ? external_data.get() : data.data();
+  }
 
 public:
   Matrix() : Matrix(0) {
@@ -31,6 +49,11 @@ public:
   Matrix(std::size_t n, T value) : n(n), data(n * n, value) {
   }
 
+  // Wrap n * n values in row-major order, without copying them.
+  Matrix(std::size_t n, std::shared_ptr<const T> external_data)
+    : n(n), external_data(std::move(external_data)) {
+  }
+
   Matrix<T> get_sub_matrix(const std::vector<Index>& indices) const {
     Matrix<T> sub_matrix(indices.size());
     for (std::size_t i = 0; i < indices.size(); ++i) {
@@ -42,10 +65,10 @@ public:
   }
 
   T* operator[](std::size_t i) {
-    return data.data() + (i * n);
+    return values() + (i * n);
   }
   const T* operator[](std::size_t i) const {
-    return data.data() + (i * n);
+    return values() + (i * n);
   }
 
   std::size_t size() const {
@@ -54,7 +77,7 @@ public:
 
 #if USE_PYTHON_BINDINGS
   T* get_data() {
-    return data.data();
+    return values();
   }
 #endif
 };
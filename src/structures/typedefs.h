@@ -26,7 +26,11 @@ namespace vroom {
 
 // To easily differentiate variable types.
 using Id = uint64_t;
+#if USE_LARGE_INDEX
+using Index = uint32_t;
+#else
 using Index = uint16_t;
+#endif
 using UserCost = uint32_t;
 // Signed cost in user units (used for reporting objective cost that may include
 // negative components such as preference penalties).
@@ -58,6 +62,10 @@ using Deadline = std::optional<TimePoint>;
 constexpr UserCost INFINITE_USER_COST =
   3 * (std::numeric_limits<UserCost>::max() / 4);
 
+// Max number of locations, jobs or vehicles. The max value is kept
+// out of range for use as a "no index" marker.
+constexpr std::size_t MAX_INDEX_SIZE = std::numeric_limits<Index>::max();
+
 const std::string DEFAULT_PROFILE = "car";
 const std::string NO_TYPE = "";
 const std::string DEFAULT_OSRM_SNAPPING_RADIUS = "35000";
@@ -83,10 +91,13 @@ constexpr UserCost DEFAULT_COST_PER_KM = 0;
 constexpr Priority MAX_PRIORITY = 100;
 constexpr double MAX_SPEED_FACTOR = 5.0;
 constexpr unsigned MAX_EXPLORATION_LEVEL = 5;
+constexpr unsigned MAX_COORDINATES_PRECISION = 9;
 
 constexpr unsigned DEFAULT_EXPLORATION_LEVEL = 5;
 constexpr unsigned DEFAULT_THREADS_NUMBER = 4;
-constexpr unsigned MAX_ROUTING_THREADS = 32;
+constexpr std::size_t DEFAULT_MATRIX_CACHE_CAPACITY = 8;
+constexpr unsigned MAX_HTTP_CONNECTIONS_PER_SERVER = 16;
+constexpr std::size_t NEAREST_JOBS_K = 32;
 
 constexpr auto DEFAULT_MAX_TASKS = std::numeric_limits<size_t>::max();
 constexpr auto DEFAULT_MAX_TRAVEL_TIME = std::numeric_limits<Duration>::max();
@@ -10,10 +10,13 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <vector>
 
 #include "structures/typedefs.h"
+#include "utils/exception.h"
 
 namespace vroom {
 
@@ -51,6 +54,10 @@ bool operator<(const AmountExpression<E1>& lhs,
   return lhs[last_rank] < rhs[last_rank];
 }
 
+// Number of leading components stored inline in Amount, further
+// components being stored on the heap.
+constexpr std::size_t INLINE_AMOUNT_SIZE = 4;
+
 template <typename E1, typename E2>
 bool operator<=(const AmountExpression<E1>& lhs,
                 const AmountExpression<E2>& rhs) {
@@ -83,77 +90,173 @@ bool operator==(const AmountExpression<E1>& lhs,
 
 class Amount : public AmountExpression<Amount> {
 
-  std::vector<Capacity> elems;
+  // The first INLINE_AMOUNT_SIZE components are stored in _inline,
+  // unused ones being zero, and components past that in _heap.
+  // Amounts with a few dimensions thus require no allocation.
+  std::size_t _size{0};
+  std::array<Capacity, INLINE_AMOUNT_SIZE> _inline{};
+  std::vector<Capacity> _heap;
+
+  // Apply op to all components of this and rhs.
+  template <typename E, typename Op>
+  void apply(const AmountExpression<E>& rhs, Op op) {
+    assert(this->size() == rhs.size());
+    for (std::size_t i = 0; i < INLINE_AMOUNT_SIZE; ++i) {
+      op(_inline[i], rhs[i]);
+    }
+    for (std::size_t i = INLINE_AMOUNT_SIZE; i < _size; ++i) {
+      op(_heap[i - INLINE_AMOUNT_SIZE], rhs[i]);
+    }
+  }
 
 public:
   Amount() = default;
 
-  explicit Amount(std::size_t size) : elems(size, 0){};
-
-  template <typename E> Amount(const AmountExpression<E>& u) {
-    elems.resize(u.size());
-    for (std::size_t i = 0; i < u.size(); ++i) {
-      elems[i] = u[i];
+  explicit Amount(std::size_t size) : _size(size) {
+    if (INLINE_AMOUNT_SIZE < size) {
+      _heap.resize(size - INLINE_AMOUNT_SIZE, 0);
     }
+  };
+
+  template <typename E> Amount(const AmountExpression<E>& u) : Amount(u.size()) {
+    apply(u, [](Capacity& c, Capacity v) { c = v; });
   }
 
   void push_back(Capacity c) {
-    elems.push_back(c);
+    if (_size < INLINE_AMOUNT_SIZE) {
+      _inline[_size] = c;
+    } else {
+      _heap.push_back(c);
+    }
+    ++_size;
   }
 
   Capacity operator[](std::size_t i) const {
-    return elems[i];
+    assert(i < std::max(_size, INLINE_AMOUNT_SIZE));
+    return (i < INLINE_AMOUNT_SIZE) ? _inline[i]
+                                    : _heap[i - INLINE_AMOUNT_SIZE];
   }
 
   Capacity& operator[](std::size_t i) {
-    return elems[i];
+    assert(i < std::max(_size, INLINE_AMOUNT_SIZE));
+    return (i < INLINE_AMOUNT_SIZE) ? _inline[i]
+                                    : _heap[i - INLINE_AMOUNT_SIZE];
   }
 
   std::size_t size() const {
-    return elems.size();
+    return _size;
   }
 
   Amount& operator+=(const Amount& rhs) {
-    assert(this->size() == rhs.size());
-    for (std::size_t i = 0; i < this->size(); ++i) {
-      (*this)[i] += rhs[i];
-    }
+    apply(rhs, [](Capacity& c, Capacity v) { c += v; });
     return *this;
   }
 
   Amount& operator-=(const Amount& rhs) {
-    assert(this->size() == rhs.size());
-    for (std::size_t i = 0; i < this->size(); ++i) {
-      (*this)[i] -= rhs[i];
-    }
+    apply(rhs, [](Capacity& c, Capacity v) { c -= v; });
     return *this;
   }
 
 #if USE_PYTHON_BINDINGS
+  // Components are only contiguous up to INLINE_AMOUNT_SIZE, so
+  // exposing larger amounts as a single buffer is not supported.
   Capacity* get_data() {
-    return elems.data();
+    if (INLINE_AMOUNT_SIZE < _size) {
+      throw InputException("Amounts with more than " +
+                           std::to_string(INLINE_AMOUNT_SIZE) +
+                           " components can't be accessed as a buffer.");
+    }
+    return _inline.data();
   };
 #endif
 
   template <class AmountExpression>
   Amount& operator+=(const AmountExpression& rhs) {
-    assert(this->size() == rhs.size());
-    for (std::size_t i = 0; i < this->size(); ++i) {
-      (*this)[i] += rhs[i];
-    }
+    apply(rhs, [](Capacity& c, Capacity v) { c += v; });
     return *this;
   }
 
   template <class AmountExpression>
   Amount& operator-=(const AmountExpression& rhs) {
-    assert(this->size() == rhs.size());
-    for (std::size_t i = 0; i < this->size(); ++i) {
-      (*this)[i] -= rhs[i];
-    }
+    apply(rhs, [](Capacity& c, Capacity v) { c -= v; });
     return *this;
   }
 };
 
+// Read-only view on amount components stored contiguously, e.g. in
+// an AmountProfile. Like Amount, components past size and up to
+// INLINE_AMOUNT_SIZE have to be readable and zero.
+class AmountView : public AmountExpression<AmountView> {
+  const Capacity* _data;
+  std::size_t _size;
+
+public:
+  AmountView(const Capacity* data, std::size_t size)
+    : _data(data), _size(size) {
+  }
+
+  Capacity operator[](std::size_t i) const {
+    return _data[i];
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+};
+
+// Amounts for consecutive ranks stored in a single flat buffer, each
+// rank using a padded stride of max(amount size, INLINE_AMOUNT_SIZE)
+// components with padding components set to zero.
+class AmountProfile {
+  std::size_t _amount_size{0};
+  std::size_t _stride{INLINE_AMOUNT_SIZE};
+  std::vector<Capacity> _values;
+
+public:
+  AmountProfile() = default;
+
+  explicit AmountProfile(std::size_t amount_size, std::size_t nb_ranks = 0)
+    : _amount_size(amount_size),
+      _stride(std::max(amount_size, INLINE_AMOUNT_SIZE)),
+      _values(nb_ranks * _stride, 0) {
+  }
+
+  std::size_t size() const {
+    return _values.size() / _stride;
+  }
+
+  // New ranks are set to zero.
+  void resize(std::size_t nb_ranks) {
+    _values.resize(nb_ranks * _stride, 0);
+  }
+
+  void fill_zero() {
+    std::ranges::fill(_values, 0);
+  }
+
+  AmountView operator[](std::size_t rank) const {
+    assert(rank < size());
+    return {_values.data() + rank * _stride, _amount_size};
+  }
+
+  AmountView back() const {
+    return (*this)[size() - 1];
+  }
+
+  Capacity* data(std::size_t rank) {
+    assert(rank < size());
+    return _values.data() + rank * _stride;
+  }
+
+  template <typename E> void set(std::size_t rank, const AmountExpression<E>& u) {
+    assert(u.size() == _amount_size);
+    auto* const values = data(rank);
+    for (std::size_t i = 0; i < _amount_size; ++i) {
+      values[i] = u[i];
+    }
+  }
+};
+
 template <typename E1, typename E2>
 class AmountSum : public AmountExpression<AmountSum<E1, E2>> {
   const E1& lhs;
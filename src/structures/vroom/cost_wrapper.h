@@ -61,6 +61,13 @@ public:
             other.discrete_distance_cost_factor);
   }
 
+  // Assuming both wrappers use the same matrices, check that they
+  // yield identical evals for any edge.
+  bool has_same_evals(const CostWrapper& other) const {
+    return has_same_variable_costs(other) &&
+           (this->discrete_duration_factor == other.discrete_duration_factor);
+  }
+
   Duration duration(Index i, Index j) const {
     return discrete_duration_factor *
            static_cast<Duration>(duration_data[i * duration_matrix_size + j]);
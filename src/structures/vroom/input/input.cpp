@@ -8,9 +8,11 @@ All rights reserved (see LICENSE).
 */
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <map>
 #include <mutex>
-#include <semaphore>
-#include <thread>
 
 #if USE_LIBOSRM
 #include "osrm/exception.hpp"
@@ -27,6 +29,7 @@ All rights reserved (see LICENSE).
 #include "routing/valhalla_wrapper.h"
 #include "structures/vroom/input/input.h"
 #include "utils/helpers.h"
+#include "utils/matrix_file.h"
 #include "utils/budget_repair.h"
 
 namespace vroom {
@@ -39,6 +42,85 @@ void Input::set_geometry(bool geometry) {
   _geometry = geometry;
 }
 
+void Input::set_thread_pool(std::shared_ptr<utils::ThreadPool> pool) {
+  _thread_pool = std::move(pool);
+}
+
+void Input::set_matrix_cache(std::shared_ptr<routing::MatrixCache> cache) {
+  _matrix_cache = std::move(cache);
+}
+
+void Input::set_matrix_block_size(std::size_t block_size) {
+  _matrix_block_size = block_size;
+}
+
+void Input::set_coordinates_precision(unsigned precision) {
+  if (!_no_addition_yet) {
+    throw InputException(
+      "Coordinates precision must be set before adding jobs or vehicles.");
+  }
+  if (precision > MAX_COORDINATES_PRECISION) {
+    throw InputException(
+      std::format("Coordinates precision can't exceed {}.",
+                  MAX_COORDINATES_PRECISION));
+  }
+
+  _coordinates_precision = precision;
+  _coordinates_factor = std::pow(10.0, precision);
+}
+
+Input::RoundedCoordinates
+Input::get_rounded_coordinates(const Location& location) const {
+  return {std::llround(location.lon() * _coordinates_factor),
+          std::llround(location.lat() * _coordinates_factor)};
+}
+
+std::optional<Index> Input::get_stored_index(const Location& location) {
+  assert(!location.user_index());
+
+  if (const auto search = _locations_to_index.find(location);
+      search != _locations_to_index.end()) {
+    return search->second;
+  }
+
+  if (_coordinates_precision.has_value()) {
+    if (const auto search =
+          _rounded_locations_to_index.find(get_rounded_coordinates(location));
+        search != _rounded_locations_to_index.end()) {
+      // Merge with stored location having close coordinates. Further
+      // lookups for those exact coordinates are served above.
+      _locations_to_index.try_emplace(location, search->second);
+      _locations_used_several_times.insert(_locations[search->second]);
+      ++_nb_merged_locations;
+      return search->second;
+    }
+  }
+
+  return std::nullopt;
+}
+
+void Input::store_location(Location& location) {
+  assert(!location.user_index());
+
+  const Index new_index = _locations.size();
+  location.set_index(new_index);
+  _locations.push_back(location);
+  _locations_to_index.try_emplace(location, new_index);
+
+  if (_coordinates_precision.has_value()) {
+    _rounded_locations_to_index.try_emplace(get_rounded_coordinates(location),
+                                            new_index);
+  }
+}
+
+void Input::init_thread_pool(unsigned nb_thread) {
+  if (_thread_pool == nullptr) {
+    // Calling thread takes part in the work.
+    _thread_pool =
+      std::make_shared<utils::ThreadPool>(std::max(nb_thread, 1u) - 1);
+  }
+}
+
 void Input::add_routing_wrapper(const std::string& profile) {
 #if !USE_ROUTING
   throw RoutingException("VROOM compiled without routing support.");
@@ -143,17 +225,13 @@ void Input::check_job(Job& job) {
   if (!job.location.user_index()) {
     // Index of job in the matrices is not specified in input, check
     // for already stored location or assign new index.
-    auto search = _locations_to_index.find(job.location);
-    if (search != _locations_to_index.end()) {
+    if (const auto index = get_stored_index(job.location); index.has_value()) {
       // Using stored index for existing location.
-      job.location.set_index(search->second);
+      job.location.set_index(index.value());
       _locations_used_several_times.insert(job.location);
     } else {
       // Append new location and store corresponding index.
-      auto new_index = _locations.size();
-      job.location.set_index(new_index);
-      _locations.push_back(job.location);
-      _locations_to_index.try_emplace(job.location, new_index);
+      store_location(job.location);
     }
   } else {
     // All jobs have a location_index in input, we only store
@@ -181,6 +259,13 @@ void Input::run_basic_checks() const {
   if (jobs.empty()) {
     throw InputException("No task defined.");
   }
+  if (_locations.size() > MAX_INDEX_SIZE || jobs.size() > MAX_INDEX_SIZE ||
+      vehicles.size() > MAX_INDEX_SIZE) {
+    throw InputException(
+      std::format("Too many locations, tasks or vehicles (max {}), build "
+                  "with USE_LARGE_INDEX=true.",
+                  MAX_INDEX_SIZE));
+  }
   if (_geometry && !_all_locations_have_coords) {
     // Early abort when info is required with missing coordinates.
     throw InputException("Route geometry request with missing coordinates.");
@@ -313,17 +398,13 @@ void Input::add_vehicle(const Vehicle& vehicle) {
       // Index of start in the matrices is not specified in input,
       // check for already stored location or assign new index.
       assert(start_loc.has_coordinates());
-      auto search = _locations_to_index.find(start_loc);
-      if (search != _locations_to_index.end()) {
+      if (const auto index = get_stored_index(start_loc); index.has_value()) {
         // Using stored index for existing location.
-        start_loc.set_index(search->second);
+        start_loc.set_index(index.value());
         _locations_used_several_times.insert(start_loc);
       } else {
         // Append new location and store corresponding index.
-        auto new_index = _locations.size();
-        start_loc.set_index(new_index);
-        _locations.push_back(start_loc);
-        _locations_to_index.try_emplace(start_loc, new_index);
+        store_location(start_loc);
       }
     } else {
       // All starts have a location_index in input, we only store
@@ -361,17 +442,13 @@ void Input::add_vehicle(const Vehicle& vehicle) {
       // Index of this end in the matrix was not specified upon
       // vehicle creation.
       assert(end_loc.has_coordinates());
-      auto search = _locations_to_index.find(end_loc);
-      if (search != _locations_to_index.end()) {
+      if (const auto index = get_stored_index(end_loc); index.has_value()) {
         // Using stored index for existing location.
-        end_loc.set_index(search->second);
+        end_loc.set_index(index.value());
         _locations_used_several_times.insert(end_loc);
       } else {
         // Append new location and store corresponding index.
-        auto new_index = _locations.size();
-        end_loc.set_index(new_index);
-        _locations.push_back(end_loc);
-        _locations_to_index.try_emplace(end_loc, new_index);
+        store_location(end_loc);
       }
     } else {
       // All ends have a location_index in input, we only store
@@ -475,6 +552,23 @@ void Input::set_costs_matrix(const std::string& profile, Matrix<UserCost>&& m) {
   _costs_matrices.insert_or_assign(profile, std::move(m));
 }
 
+void Input::set_matrix_file(const std::string& file_path) {
+  auto [profile, type, matrix] = io::map_matrix_file(file_path);
+
+  switch (type) {
+    using enum io::MATRIX_TYPE;
+  case DURATIONS:
+    set_durations_matrix(profile, std::move(matrix));
+    break;
+  case DISTANCES:
+    set_distances_matrix(profile, std::move(matrix));
+    break;
+  case COSTS:
+    set_costs_matrix(profile, std::move(matrix));
+    break;
+  }
+}
+
 bool Input::is_used_several_times(const Location& location) const {
   return _locations_used_several_times.contains(location);
 }
@@ -730,6 +824,42 @@ void Input::set_vehicles_costs() {
   }
 }
 
+void Input::set_vehicles_classes() {
+  _vehicle_cost_classes.resize(vehicles.size());
+  _cost_class_vehicles.clear();
+  _vehicle_penalty_classes.resize(vehicles.size());
+  _penalty_class_vehicles.clear();
+
+  // Penalty classes are keyed by the penalties of all jobs for a
+  // given vehicle.
+  std::map<std::vector<Cost>, Index> penalties_to_class;
+
+  for (Index v = 0; v < vehicles.size(); ++v) {
+    const auto cost_class =
+      std::ranges::find_if(_cost_class_vehicles, [&](const auto other_v) {
+        return vehicles[v].has_same_evals(vehicles[other_v]);
+      });
+    _vehicle_cost_classes[v] =
+      std::distance(_cost_class_vehicles.begin(), cost_class);
+    if (cost_class == _cost_class_vehicles.end()) {
+      _cost_class_vehicles.push_back(v);
+    }
+
+    std::vector<Cost> penalties;
+    penalties.reserve(_job_vehicle_penalties.size());
+    for (const auto& job_penalties : _job_vehicle_penalties) {
+      penalties.push_back(job_penalties[v]);
+    }
+    const auto [penalty_class, inserted] =
+      penalties_to_class.try_emplace(std::move(penalties),
+                                     _penalty_class_vehicles.size());
+    _vehicle_penalty_classes[v] = penalty_class->second;
+    if (inserted) {
+      _penalty_class_vehicles.push_back(v);
+    }
+  }
+}
+
 void Input::set_vehicles_max_tasks() {
   if (const auto amount_size = get_amount_size();
       _has_jobs && !_has_shipments && amount_size > 0) {
@@ -946,6 +1076,95 @@ void Input::set_jobs_durations_per_vehicle_type() {
   }
 }
 
+void Input::init_nearest_jobs() {
+  _nearest_jobs = std::vector<NearestJobs>(_cost_class_vehicles.size());
+  _nearest_jobs_built =
+    std::make_unique<std::once_flag[]>(_cost_class_vehicles.size());
+}
+
+const Input::NearestJobs& Input::get_nearest_jobs(Index cost_class) const {
+  assert(cost_class < _nearest_jobs.size());
+  auto& nearest_jobs = _nearest_jobs[cost_class];
+
+  std::call_once(_nearest_jobs_built[cost_class], [&] {
+    const auto& vehicle = vehicles[_cost_class_vehicles[cost_class]];
+    const std::size_t k =
+      jobs.empty()
+        ? 0
+        : std::min(std::max(NEAREST_JOBS_K,
+                            static_cast<std::size_t>(_granular_jobs_k)),
+                   jobs.size() - 1);
+    nearest_jobs.k = k;
+    nearest_jobs.from.resize(jobs.size() * k);
+    nearest_jobs.to.resize(jobs.size() * k);
+
+    // Sorting pairs breaks ties on job rank.
+    std::vector<std::pair<Cost, Index>> from_costs;
+    std::vector<std::pair<Cost, Index>> to_costs;
+    from_costs.reserve(jobs.size());
+    to_costs.reserve(jobs.size());
+
+    for (Index j = 0; j < jobs.size(); ++j) {
+      const auto j_index = jobs[j].index();
+
+      from_costs.clear();
+      to_costs.clear();
+      for (Index other = 0; other < jobs.size(); ++other) {
+        if (other == j) {
+          continue;
+        }
+        const auto other_index = jobs[other].index();
+        from_costs.emplace_back(vehicle.cost(j_index, other_index), other);
+        to_costs.emplace_back(vehicle.cost(other_index, j_index), other);
+      }
+
+      std::ranges::partial_sort(from_costs, from_costs.begin() + k);
+      std::ranges::partial_sort(to_costs, to_costs.begin() + k);
+
+      for (std::size_t i = 0; i < k; ++i) {
+        nearest_jobs.from[j * k + i] = from_costs[i].second;
+        nearest_jobs.to[j * k + i] = to_costs[i].second;
+      }
+    }
+  });
+
+  return nearest_jobs;
+}
+
+std::span<const Index> Input::nearest_jobs_from(Index cost_class,
+                                                Index j) const {
+  const auto& nearest_jobs = get_nearest_jobs(cost_class);
+  return {nearest_jobs.from.data() + j * nearest_jobs.k, nearest_jobs.k};
+}
+
+std::span<const Index> Input::nearest_jobs_to(Index cost_class,
+                                              Index j) const {
+  const auto& nearest_jobs = get_nearest_jobs(cost_class);
+  return {nearest_jobs.to.data() + j * nearest_jobs.k, nearest_jobs.k};
+}
+
+bool Input::is_granular_arc(Index v, Index from_j, Index to_j) const {
+  if (_granular_jobs_k == 0) {
+    return true;
+  }
+
+  const auto cost_class = vehicle_cost_class(v);
+
+  const auto from_nearest = nearest_jobs_from(cost_class, from_j);
+  const auto from_size =
+    std::min(from_nearest.size(), static_cast<std::size_t>(_granular_jobs_k));
+  if (const auto granular_from = from_nearest.first(from_size);
+      std::ranges::find(granular_from, to_j) != granular_from.end()) {
+    return true;
+  }
+
+  const auto to_nearest = nearest_jobs_to(cost_class, to_j);
+  const auto to_size =
+    std::min(to_nearest.size(), static_cast<std::size_t>(_granular_jobs_k));
+  const auto granular_to = to_nearest.first(to_size);
+  return std::ranges::find(granular_to, from_j) != granular_to.end();
+}
+
 void Input::set_vehicle_steps_ranks() {
   // Ensure pinned vector is sized before we record pinned vehicles
   if (_pinned_vehicle_by_job.size() != jobs.size()) {
@@ -1341,14 +1560,30 @@ routing::Matrices Input::get_matrices_by_profile(const std::string& profile,
 
   // Note: get_sparse_matrices relies on getting in input *all*
   // vehicles as it refers to vehicle ranks to store geometries.
-  return sparse_filling ? (*rw)->get_sparse_matrices(_locations,
-                                                     this->vehicles,
-                                                     this->jobs,
-                                                     _vehicles_geometry)
-                        : (*rw)->get_matrices(_locations);
+  if (sparse_filling) {
+    return (*rw)->get_sparse_matrices(*_thread_pool,
+                                      _locations,
+                                      this->vehicles,
+                                      this->jobs,
+                                      _vehicles_geometry);
+  }
+
+#if USE_ROUTING
+  if (_matrix_cache != nullptr) {
+    return _matrix_cache->get_matrices(**rw,
+                                       *_thread_pool,
+                                       _locations,
+                                       _matrix_block_size,
+                                       _matrix_cache_stats);
+  }
+#endif
+
+  return (*rw)->get_tiled_matrices(*_thread_pool,
+                                   _locations,
+                                   _matrix_block_size);
 }
 
-void Input::set_matrices(unsigned nb_thread, bool sparse_filling) {
+bool Input::set_matrices(unsigned nb_thread, bool sparse_filling) {
   if ((!_durations_matrices.empty() || !_distances_matrices.empty() ||
        !_costs_matrices.empty()) &&
       !_has_custom_location_index) {
@@ -1393,132 +1628,118 @@ void Input::set_matrices(unsigned nb_thread, bool sparse_filling) {
     init_missing_matrices(profile);
   }
 
-  std::exception_ptr ep = nullptr;
-  std::mutex ep_m;
   std::mutex cost_bound_m;
+  std::atomic<bool> computed{false};
 
   auto run_on_profiles = [&](const std::vector<std::string>& profiles) {
-    try {
-      for (const auto& profile : profiles) {
-        auto durations_m = _durations_matrices.find(profile);
-        auto distances_m = _distances_matrices.find(profile);
-
-        // Required matrices not manually set have been defined as
-        // empty above in init_missing_matrices.
-        assert(durations_m != _durations_matrices.end());
-        assert(distances_m != _distances_matrices.end());
-        const bool define_durations = (durations_m->second.size() == 0);
-        const bool define_distances = (distances_m->second.size() == 0);
-        assert(!define_durations || define_distances);
-
-        if (define_durations || define_distances) {
-          if (_locations.size() == 1) {
-            durations_m->second = Matrix<UserDuration>(1);
-            distances_m->second = Matrix<UserDistance>(1);
-          } else {
-            auto matrices = get_matrices_by_profile(profile, sparse_filling);
+    for (const auto& profile : profiles) {
+      auto durations_m = _durations_matrices.find(profile);
+      auto distances_m = _distances_matrices.find(profile);
+
+      // Required matrices not manually set have been defined as
+      // empty above in init_missing_matrices.
+      assert(durations_m != _durations_matrices.end());
+      assert(distances_m != _distances_matrices.end());
+      const bool define_durations = (durations_m->second.size() == 0);
+      const bool define_distances = (distances_m->second.size() == 0);
+      assert(!define_durations || define_distances);
+
+      if (define_durations || define_distances) {
+        if (_locations.size() == 1) {
+          durations_m->second = Matrix<UserDuration>(1);
+          distances_m->second = Matrix<UserDistance>(1);
+        } else {
+          auto matrices = get_matrices_by_profile(profile, sparse_filling);
+          computed = true;
 
-            if (!_has_custom_location_index) {
-              // Location indices are set based on order in _locations.
-              if (define_durations) {
-                durations_m->second = std::move(matrices.durations);
-              }
-              if (define_distances) {
-                distances_m->second = std::move(matrices.distances);
-              }
-            } else {
-              // Location indices are provided in input so we need an
-              // indirection based on order in _locations.
-              if (define_durations) {
-                Matrix<UserDuration> full_m(_max_matrices_used_index + 1);
-                for (Index i = 0; i < _locations.size(); ++i) {
-                  const auto& loc_i = _locations[i];
-                  for (Index j = 0; j < _locations.size(); ++j) {
-                    full_m[loc_i.index()][_locations[j].index()] =
-                      matrices.durations[i][j];
-                  }
+          if (!_has_custom_location_index) {
+            // Location indices are set based on order in _locations.
+            if (define_durations) {
+              durations_m->second = std::move(matrices.durations);
+            }
+            if (define_distances) {
+              distances_m->second = std::move(matrices.distances);
+            }
+          } else {
+            // Location indices are provided in input so we need an
+            // indirection based on order in _locations.
+            if (define_durations) {
+              Matrix<UserDuration> full_m(_max_matrices_used_index + 1);
+              for (Index i = 0; i < _locations.size(); ++i) {
+                const auto& loc_i = _locations[i];
+                for (Index j = 0; j < _locations.size(); ++j) {
+                  full_m[loc_i.index()][_locations[j].index()] =
+                    matrices.durations[i][j];
                 }
-
-                durations_m->second = std::move(full_m);
               }
-              if (define_distances) {
-                Matrix<UserDistance> full_m(_max_matrices_used_index + 1);
-                for (Index i = 0; i < _locations.size(); ++i) {
-                  const auto& loc_i = _locations[i];
-                  for (Index j = 0; j < _locations.size(); ++j) {
-                    full_m[loc_i.index()][_locations[j].index()] =
-                      matrices.distances[i][j];
-                  }
-                }
 
-                distances_m->second = std::move(full_m);
+              durations_m->second = std::move(full_m);
+            }
+            if (define_distances) {
+              Matrix<UserDistance> full_m(_max_matrices_used_index + 1);
+              for (Index i = 0; i < _locations.size(); ++i) {
+                const auto& loc_i = _locations[i];
+                for (Index j = 0; j < _locations.size(); ++j) {
+                  full_m[loc_i.index()][_locations[j].index()] =
+                    matrices.distances[i][j];
+                }
               }
+
+              distances_m->second = std::move(full_m);
             }
           }
         }
+      }
 
-        if (durations_m->second.size() <= _max_matrices_used_index) {
-          throw InputException(
-            "location_index exceeding durations matrix size for " + profile +
-            " profile.");
-        }
+      if (durations_m->second.size() <= _max_matrices_used_index) {
+        throw InputException(
+          "location_index exceeding durations matrix size for " + profile +
+          " profile.");
+      }
+
+      if (distances_m->second.size() <= _max_matrices_used_index) {
+        throw InputException(
+          "location_index exceeding distances matrix size for " + profile +
+          " profile.");
+      }
+
+      const auto c_m = _costs_matrices.find(profile);
 
-        if (distances_m->second.size() <= _max_matrices_used_index) {
+      if (c_m != _costs_matrices.end()) {
+        if (c_m->second.size() <= _max_matrices_used_index) {
           throw InputException(
-            "location_index exceeding distances matrix size for " + profile +
+            "location_index exceeding costs matrix size for " + profile +
             " profile.");
         }
 
-        const auto c_m = _costs_matrices.find(profile);
-
-        if (c_m != _costs_matrices.end()) {
-          if (c_m->second.size() <= _max_matrices_used_index) {
-            throw InputException(
-              "location_index exceeding costs matrix size for " + profile +
-              " profile.");
-          }
-
-          // Check for potential overflow in solution cost.
-          const UserCost current_bound = check_cost_bound(c_m->second);
-          const std::scoped_lock<std::mutex> lock(cost_bound_m);
-          _cost_upper_bound =
-            std::max(_cost_upper_bound,
-                     utils::scale_from_user_cost(current_bound));
-        } else {
-          // Durations matrix will be used for costs.
-          const UserCost current_bound = check_cost_bound(durations_m->second);
-
-          auto search = _max_cost_per_hour.find(profile);
-          assert(search != _max_cost_per_hour.end());
-          const auto max_cost_per_hour_for_profile = search->second;
-
-          const std::scoped_lock<std::mutex> lock(cost_bound_m);
-          _cost_upper_bound =
-            std::max(_cost_upper_bound,
-                     max_cost_per_hour_for_profile *
-                       utils::scale_from_user_duration(current_bound));
-        }
+        // Check for potential overflow in solution cost.
+        const UserCost current_bound = check_cost_bound(c_m->second);
+        const std::scoped_lock<std::mutex> lock(cost_bound_m);
+        _cost_upper_bound =
+          std::max(_cost_upper_bound,
+                   utils::scale_from_user_cost(current_bound));
+      } else {
+        // Durations matrix will be used for costs.
+        const UserCost current_bound = check_cost_bound(durations_m->second);
+
+        auto search = _max_cost_per_hour.find(profile);
+        assert(search != _max_cost_per_hour.end());
+        const auto max_cost_per_hour_for_profile = search->second;
+
+        const std::scoped_lock<std::mutex> lock(cost_bound_m);
+        _cost_upper_bound =
+          std::max(_cost_upper_bound,
+                   max_cost_per_hour_for_profile *
+                     utils::scale_from_user_duration(current_bound));
       }
-    } catch (...) {
-      const std::scoped_lock<std::mutex> lock(ep_m);
-      ep = std::current_exception();
     }
   };
 
-  std::vector<std::thread> matrix_threads;
-  matrix_threads.reserve(thread_profiles.size());
-
-  for (const auto& profiles : thread_profiles) {
-    matrix_threads.emplace_back(run_on_profiles, profiles);
-  }
-
-  for (auto& t : matrix_threads) {
-    t.join();
-  }
+  _thread_pool->parallel_for(thread_profiles.size(), [&](std::size_t i) {
+    run_on_profiles(thread_profiles[i]);
+  });
 
-  if (ep != nullptr) {
-    std::rethrow_exception(ep);
-  }
+  return computed;
 }
 
 std::unique_ptr<VRP> Input::get_problem() const {
@@ -1547,6 +1768,8 @@ Solution Input::solve(const unsigned nb_searches,
                       const std::vector<HeuristicParameters>& h_param) {
   run_basic_checks();
 
+  init_thread_pool(nb_thread);
+
   // Pinned tasks require solving mode with vehicle.steps
   bool has_pinned = std::ranges::any_of(jobs, [](const Job& j) {
     return j.pinned;
@@ -1561,19 +1784,104 @@ Solution Input::solve(const unsigned nb_searches,
       it->id));
   }
 
-  if (_has_initial_routes) {
-    set_vehicle_steps_ranks();
+  // Computing matrices is mostly spent waiting for the routing
+  // engine, so it is queued on the pool while preprocessing steps
+  // that don't rely on matrices run on the calling thread. The task
+  // is claimed by whichever thread gets to it first: if no worker
+  // started it by the end of preprocessing (e.g. all workers of a
+  // shared pool being busy), it runs on the calling thread.
+  TimePoint matrices_start;
+  TimePoint matrices_end;
+  bool matrices_computed = false;
+  auto matrices_done = std::make_shared<std::promise<void>>();
+  auto matrices_future = matrices_done->get_future();
+  auto matrices_claimed = std::make_shared<std::atomic<bool>>(false);
+
+  auto run_set_matrices = [this,
+                           nb_thread,
+                           matrices_done,
+                           &matrices_start,
+                           &matrices_end,
+                           &matrices_computed]() {
+    matrices_start = std::chrono::high_resolution_clock::now();
+    try {
+      matrices_computed = set_matrices(nb_thread);
+      matrices_end = std::chrono::high_resolution_clock::now();
+      matrices_done->set_value();
+    } catch (...) {
+      matrices_end = std::chrono::high_resolution_clock::now();
+      matrices_done->set_exception(std::current_exception());
+    }
+  };
+
+  if (_thread_pool->nb_workers() > 0) {
+    _thread_pool->submit([run_set_matrices, matrices_claimed]() {
+      if (!matrices_claimed->exchange(true)) {
+        run_set_matrices();
+      }
+    });
   }
 
-  init_exclusive_tags();
+  const auto get_matrices = [&]() {
+    if (!matrices_claimed->exchange(true)) {
+      run_set_matrices();
+    }
+    matrices_future.get();
+  };
 
-  set_jobs_durations_per_vehicle_type();
+  const auto preprocessing_start = std::chrono::high_resolution_clock::now();
+  try {
+    if (_has_initial_routes) {
+      set_vehicle_steps_ranks();
+    }
+
+    init_exclusive_tags();
+
+    set_jobs_durations_per_vehicle_type();
+  } catch (...) {
+    // Errors from those steps are reported over any matrix error. A
+    // matrices task already started still refers to this scope, else
+    // it is claimed so that it never runs.
+    if (matrices_claimed->exchange(true)) {
+      matrices_future.wait();
+    }
+    throw;
+  }
+
+  try {
+    // Fill vehicle/job compatibility matrices.
+    set_skills_compatibility();
+  } catch (...) {
+    // Matrix errors take precedence.
+    get_matrices();
+    throw;
+  }
+  const auto preprocessing_end = std::chrono::high_resolution_clock::now();
+
+  get_matrices();
+
+  std::optional<MatricesTimes> matrices_times;
+  if (matrices_computed) {
+    matrices_times = MatricesTimes();
+    matrices_times->duration =
+      std::chrono::duration_cast<std::chrono::milliseconds>(matrices_end -
+                                                            matrices_start)
+        .count();
+
+    const auto overlap_end = std::min(matrices_end, preprocessing_end);
+    const auto overlap_start = std::max(matrices_start, preprocessing_start);
+    if (overlap_start < overlap_end) {
+      matrices_times->overlap =
+        std::chrono::duration_cast<std::chrono::milliseconds>(overlap_end -
+                                                              overlap_start)
+          .count();
+    }
+  }
 
-  set_matrices(nb_thread);
   set_vehicles_costs();
+  set_vehicles_classes();
+  init_nearest_jobs();
 
-  // Fill vehicle/job compatibility matrices.
-  set_skills_compatibility();
   set_extra_compatibility();
   enforce_pinned_eligibility();
   set_vehicles_compatibility();
@@ -1606,6 +1914,13 @@ Solution Input::solve(const unsigned nb_searches,
 
   // Update timing info.
   sol.summary.computing_times.loading = loading.count();
+  sol.summary.computing_times.matrices = matrices_times;
+  if (_coordinates_precision.has_value()) {
+    sol.summary.merged_locations = _nb_merged_locations;
+  }
+  if (_matrix_cache != nullptr) {
+    sol.summary.computing_times.matrix_cache = _matrix_cache_stats;
+  }
 
   _end_solving = std::chrono::high_resolution_clock::now();
   sol.summary.computing_times.solving =
@@ -1700,45 +2015,20 @@ Solution Input::solve(const unsigned nb_searches,
   }
 
   if (_geometry) {
-    std::vector<std::thread> threads;
-    threads.reserve(sol.routes.size());
-    std::exception_ptr ep = nullptr;
-    std::mutex ep_m;
-    std::counting_semaphore<MAX_ROUTING_THREADS> semaphore(
-      std::min(MAX_ROUTING_THREADS, nb_thread));
-
-    auto run_routing = [this, &semaphore, &sol, &ep, &ep_m](std::size_t i) {
-      semaphore.acquire();
-      try {
-        auto& route = sol.routes[i];
-        const auto& profile = route.profile;
-        auto rw = std::ranges::find_if(_routing_wrappers, [&](const auto& wr) {
-          return wr->profile == profile;
-        });
-        if (rw == _routing_wrappers.end()) {
-          throw InputException(
-            "Route geometry request with non-routable profile " + profile +
-            ".");
-        }
-        (*rw)->add_geometry(route);
-      } catch (...) {
-        const std::scoped_lock<std::mutex> lock(ep_m);
-        ep = std::current_exception();
+    auto run_routing = [this, &sol](std::size_t i) {
+      auto& route = sol.routes[i];
+      const auto& profile = route.profile;
+      auto rw = std::ranges::find_if(_routing_wrappers, [&](const auto& wr) {
+        return wr->profile == profile;
+      });
+      if (rw == _routing_wrappers.end()) {
+        throw InputException(
+          "Route geometry request with non-routable profile " + profile + ".");
       }
-      semaphore.release();
+      (*rw)->add_geometry(route);
     };
 
-    for (std::size_t i = 0; i < sol.routes.size(); ++i) {
-      threads.emplace_back(run_routing, i);
-    }
-
-    for (auto& t : threads) {
-      t.join();
-    }
-
-    if (ep != nullptr) {
-      std::rethrow_exception(ep);
-    }
+    _thread_pool->parallel_for(sol.routes.size(), run_routing, nb_thread);
 
     _end_routing = std::chrono::high_resolution_clock::now();
     auto routing = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -1761,6 +2051,8 @@ Solution Input::check(unsigned nb_thread) {
 #if USE_LIBGLPK
   run_basic_checks();
 
+  init_thread_pool(nb_thread);
+
   set_jobs_durations_per_vehicle_type();
 
   set_vehicle_steps_ranks();
@@ -1787,6 +2079,9 @@ Solution Input::check(unsigned nb_thread) {
 
   // Update timing info.
   sol.summary.computing_times.loading = loading;
+  if (_coordinates_precision.has_value()) {
+    sol.summary.merged_locations = _nb_merged_locations;
+  }
 
   _end_solving = std::chrono::high_resolution_clock::now();
   sol.summary.computing_times.solving =
@@ -12,16 +12,20 @@ All rights reserved (see LICENSE).
 
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <utility>
 
+#include "routing/matrix_cache.h"
 #include "routing/wrapper.h"
 #include "structures/generic/matrix.h"
 #include "structures/typedefs.h"
 #include "structures/vroom/matrices.h"
 #include "structures/vroom/solution/solution.h"
 #include "structures/vroom/vehicle.h"
+#include "utils/thread_pool.h"
 
 namespace vroom {
 
@@ -88,6 +92,22 @@ private:
   std::vector<Location> _locations;
   std::unordered_map<Location, Index> _locations_to_index;
   std::unordered_set<Location> _locations_used_several_times;
+
+  // Coordinates rounded to _coordinates_precision decimals, used to
+  // merge locations with close coordinates.
+  using RoundedCoordinates = std::pair<int64_t, int64_t>;
+  struct RoundedCoordinatesHash {
+    std::size_t operator()(const RoundedCoordinates& c) const {
+      return std::hash<int64_t>()(c.first) ^
+             (std::hash<int64_t>()(c.second) << 1);
+    }
+  };
+  std::optional<unsigned> _coordinates_precision;
+  double _coordinates_factor{1};
+  std::unordered_map<RoundedCoordinates, Index, RoundedCoordinatesHash>
+    _rounded_locations_to_index;
+  unsigned _nb_merged_locations{0};
+
   std::vector<std::vector<unsigned char>> _vehicle_to_job_compatibility;
   std::vector<std::vector<bool>> _vehicle_to_vehicle_compatibility;
   // For pinned semantics: if set, job j must stay on pinned vehicle
@@ -101,6 +121,23 @@ private:
   std::vector<std::vector<Eval>> _jobs_vehicles_evals;
   // Repair tuning: max candidate unassigned jobs/shipments to consider for densify
   unsigned _budget_densify_candidates_k{20};
+  // Local search: number of nearest routes for which cost tables are
+  // stored for each route, 0 meaning all routes.
+  unsigned _granular_routes_k{0};
+  // Local search: number of nearest jobs considered as neighbours of
+  // each job when evaluating moves, 0 meaning all jobs.
+  unsigned _granular_jobs_k{0};
+
+  // Nearest jobs lists for each job based on costs for a given cost
+  // class, stored in rows of size k. Lists are only built upon first
+  // use for each cost class as they're not required for all classes.
+  struct NearestJobs {
+    std::size_t k{0};
+    std::vector<Index> from;
+    std::vector<Index> to;
+  };
+  mutable std::vector<NearestJobs> _nearest_jobs;
+  mutable std::unique_ptr<std::once_flag[]> _nearest_jobs_built;
 
   // Exclusive tags: normalize tag values to compact indices.
   std::unordered_map<ExclusiveTag, Index> _exclusive_tag_to_rank;
@@ -118,6 +155,15 @@ private:
   // Per-(job_rank, vehicle_rank) objective penalties (internal Cost units).
   std::vector<std::vector<Cost>> _job_vehicle_penalties;
 
+  // Vehicles in the same cost class yield identical evals for any
+  // edge, vehicles in the same penalty class have identical
+  // penalties for all jobs. Classes are stored along with the rank of
+  // one vehicle in each class.
+  std::vector<Index> _vehicle_cost_classes;
+  std::vector<Index> _cost_class_vehicles;
+  std::vector<Index> _vehicle_penalty_classes;
+  std::vector<Index> _penalty_class_vehicles;
+
   // Default vehicle type is NO_TYPE, related to the fact that we do
   // not allow empty types as keys for jobs.
   std::vector<std::string> _vehicle_types{NO_TYPE};
@@ -134,6 +180,18 @@ private:
   const io::Servers _servers;
   const ROUTER _router;
 
+  // Executor for all parallel work, either injected using
+  // set_thread_pool or created upon solving based on nb_thread.
+  std::shared_ptr<utils::ThreadPool> _thread_pool;
+
+  // Optional cache for matrices computed by routing wrappers.
+  std::shared_ptr<routing::MatrixCache> _matrix_cache;
+  MatrixCacheStats _matrix_cache_stats;
+
+  // Max number of sources and destinations in matrix requests sent to
+  // routing engines, 0 meaning no limit.
+  std::size_t _matrix_block_size{0};
+
   std::unique_ptr<VRP> get_problem() const;
 
   void check_amount_size(const Amount& amount);
@@ -147,9 +205,22 @@ private:
   void set_extra_compatibility();
   void set_vehicles_compatibility();
   void set_vehicles_costs();
+  void set_vehicles_classes();
   void set_vehicles_max_tasks();
   void set_jobs_vehicles_evals();
   void set_jobs_durations_per_vehicle_type();
+  void init_nearest_jobs();
+  const NearestJobs& get_nearest_jobs(Index cost_class) const;
+  RoundedCoordinates get_rounded_coordinates(const Location& location) const;
+
+  // Index for an already stored location with no user-provided
+  // index, if any.
+  std::optional<Index> get_stored_index(const Location& location);
+
+  // Set index for a new location with no user-provided index and
+  // store it.
+  void store_location(Location& location);
+
   void set_vehicle_steps_ranks();
   void init_exclusive_tags();
   void init_missing_matrices(const std::string& profile);
@@ -157,7 +228,11 @@ private:
   routing::Matrices get_matrices_by_profile(const std::string& profile,
                                             bool sparse_filling);
 
-  void set_matrices(unsigned nb_thread, bool sparse_filling = false);
+  // Return true if any matrix has been computed by a routing engine,
+  // as opposed to all matrices being provided in input.
+  bool set_matrices(unsigned nb_thread, bool sparse_filling = false);
+
+  void init_thread_pool(unsigned nb_thread);
 
   void add_routing_wrapper(const std::string& profile);
 
@@ -206,6 +281,31 @@ public:
 
   void set_geometry(bool geometry);
 
+  // Share an existing pool, e.g. across several Input instances in an
+  // embedding process. Concurrency for a given solving is still
+  // limited by the nb_thread value passed to solve or check.
+  void set_thread_pool(std::shared_ptr<utils::ThreadPool> pool);
+
+  utils::ThreadPool& thread_pool() const {
+    assert(_thread_pool != nullptr);
+    return *_thread_pool;
+  }
+
+  // Serve matrices computed by routing wrappers from cache, which may
+  // be shared across several Input instances.
+  void set_matrix_cache(std::shared_ptr<routing::MatrixCache> cache);
+
+  // Split matrix requests to routing engines in blocks of at most
+  // block_size sources and destinations, e.g. to comply with server
+  // limits on table size. Blocks are requested concurrently.
+  void set_matrix_block_size(std::size_t block_size);
+
+  // Merge locations whose coordinates are equal once rounded to
+  // precision decimals, so they share the same matrices index. Only
+  // applies to locations without user-provided index and must be set
+  // before adding any job or vehicle.
+  void set_coordinates_precision(unsigned precision);
+
   void add_job(const Job& job);
 
   void add_shipment(const Job& pickup, const Job& delivery);
@@ -220,6 +320,11 @@ public:
 
   void set_costs_matrix(const std::string& profile, Matrix<UserCost>&& m);
 
+  // Use matrix from a binary file (see utils/matrix_file.h), mapped
+  // in memory without copy. Profile and matrix type are read from the
+  // file header.
+  void set_matrix_file(const std::string& file_path);
+
   const Amount& zero_amount() const {
     return _zero;
   }
@@ -300,6 +405,47 @@ public:
     return _job_vehicle_penalties[job_rank][v_rank];
   }
 
+  Index vehicle_cost_class(Index v_rank) const {
+    assert(v_rank < _vehicle_cost_classes.size());
+    return _vehicle_cost_classes[v_rank];
+  }
+
+  std::size_t nb_cost_classes() const {
+    return _cost_class_vehicles.size();
+  }
+
+  Index cost_class_vehicle(Index c) const {
+    assert(c < _cost_class_vehicles.size());
+    return _cost_class_vehicles[c];
+  }
+
+  // Up to max(NEAREST_JOBS_K, granular_jobs_k) job ranks other than
+  // j sorted by increasing cost from (resp. to) job j for vehicles in
+  // cost_class, ties being broken on job rank.
+  std::span<const Index> nearest_jobs_from(Index cost_class, Index j) const;
+  std::span<const Index> nearest_jobs_to(Index cost_class, Index j) const;
+
+  // Whether the arc from job from_j to job to_j should be considered
+  // by local search moves for vehicle v, i.e. to_j is among the
+  // granular_jobs_k nearest jobs from from_j or from_j is among the
+  // granular_jobs_k nearest jobs to to_j. Always true if
+  // granular_jobs_k is 0.
+  bool is_granular_arc(Index v, Index from_j, Index to_j) const;
+
+  Index vehicle_penalty_class(Index v_rank) const {
+    assert(v_rank < _vehicle_penalty_classes.size());
+    return _vehicle_penalty_classes[v_rank];
+  }
+
+  std::size_t nb_penalty_classes() const {
+    return _penalty_class_vehicles.size();
+  }
+
+  Index penalty_class_vehicle(Index c) const {
+    assert(c < _penalty_class_vehicles.size());
+    return _penalty_class_vehicles[c];
+  }
+
   // Pinned helpers
   bool job_is_pinned(Index job_rank) const {
     return _pinned_vehicle_by_job.size() > job_rank &&
@@ -341,6 +487,20 @@ public:
     return _budget_densify_candidates_k;
   }
 
+  // Local search granularity
+  void set_granular_routes_k(unsigned k) {
+    _granular_routes_k = k;
+  }
+  unsigned granular_routes_k() const {
+    return _granular_routes_k;
+  }
+  void set_granular_jobs_k(unsigned k) {
+    _granular_jobs_k = k;
+  }
+  unsigned granular_jobs_k() const {
+    return _granular_jobs_k;
+  }
+
   Solution solve(unsigned nb_searches,
                  unsigned depth,
                  unsigned nb_thread,
@@ -10,6 +10,10 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <vector>
+
+#include "structures/generic/matrix.h"
+
 namespace vroom::routing {
 
 struct Matrices {
@@ -19,5 +23,36 @@ struct Matrices {
   explicit Matrices(std::size_t n) : durations(n), distances(n){};
 };
 
+// Rectangular matrices from sources (rows) to destinations (columns),
+// values being stored in row-major order.
+struct MatricesBlock {
+  std::size_t nb_rows;
+  std::size_t nb_cols;
+  std::vector<UserDuration> durations;
+  std::vector<UserDistance> distances;
+
+  MatricesBlock(std::size_t nb_rows, std::size_t nb_cols)
+    : nb_rows(nb_rows),
+      nb_cols(nb_cols),
+      durations(nb_rows * nb_cols),
+      distances(nb_rows * nb_cols){};
+
+  UserDuration& duration(std::size_t i, std::size_t j) {
+    return durations[i * nb_cols + j];
+  }
+
+  UserDuration duration(std::size_t i, std::size_t j) const {
+    return durations[i * nb_cols + j];
+  }
+
+  UserDistance& distance(std::size_t i, std::size_t j) {
+    return distances[i * nb_cols + j];
+  }
+
+  UserDistance distance(std::size_t i, std::size_t j) const {
+    return distances[i * nb_cols + j];
+  }
+};
+
 } // namespace vroom::routing
 #endif
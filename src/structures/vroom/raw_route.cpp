@@ -15,8 +15,14 @@ RawRoute::RawRoute(const Input& input, Index i, unsigned amount_size)
   : _zero(amount_size),
     _exclusive_tag_counts(input.exclusive_tag_count(), 0),
     _exclusive_tag_limits(input.exclusive_tag_count(), 1),
-    _fwd_peaks(2, _zero),
-    _bwd_peaks(2, _zero),
+    _fwd_pickups(amount_size),
+    _fwd_deliveries(amount_size),
+    _bwd_deliveries(amount_size),
+    _bwd_pickups(amount_size),
+    _pd_loads(amount_size),
+    _current_loads(amount_size, 2),
+    _fwd_peaks(amount_size, 2),
+    _bwd_peaks(amount_size, 2),
     _delivery_margin(input.vehicles[i].capacity),
     _pickup_margin(input.vehicles[i].capacity),
     v_rank(i),
@@ -38,7 +44,7 @@ void RawRoute::set_route(const Input& input, const std::vector<Index>& r) {
   update_amounts(input);
 }
 
-void RawRoute::update_amounts(const Input& input) {
+void RawRoute::update_amounts(const Input& input, const Index first_rank) {
   if (_exclusive_tag_counts.size() != input.exclusive_tag_count()) {
     _exclusive_tag_counts.assign(input.exclusive_tag_count(), 0);
   } else {
@@ -71,21 +77,41 @@ void RawRoute::update_amounts(const Input& input) {
   if (route.empty()) {
     // So that check in is_valid_addition_for_capacity is consistent
     // with empty routes.
-    std::ranges::fill(_fwd_peaks, _zero);
-    std::ranges::fill(_bwd_peaks, _zero);
+    _fwd_peaks.fill_zero();
+    _bwd_peaks.fill_zero();
     // So that check against break max_load and margins computations
     // are consistent with empty routes.
-    std::ranges::fill(_current_loads, _zero);
+    _current_loads.fill_zero();
     return;
   }
 
+  if (!_exclusive_tag_counts.empty()) {
+    for (const auto j : route) {
+      for (const auto tid : input.exclusive_tag_ids(j)) {
+        assert(tid < _exclusive_tag_counts.size());
+        _exclusive_tag_counts[tid] += 1;
+      }
+    }
+  }
+
+  // Forward profiles are still valid up to first_rank.
+  const std::size_t fwd_start = std::min<std::size_t>(first_rank, route.size());
+
   Amount current_pickups(_zero);
   Amount current_deliveries(_zero);
   Amount current_pd_load(_zero);
   unsigned current_nb_pickups = 0;
   unsigned current_nb_deliveries = 0;
 
-  for (std::size_t i = 0; i < route.size(); ++i) {
+  if (fwd_start > 0) {
+    current_pickups = _fwd_pickups[fwd_start - 1];
+    current_deliveries = _fwd_deliveries[fwd_start - 1];
+    current_pd_load = _pd_loads[fwd_start - 1];
+    current_nb_pickups = _nb_pickups[fwd_start - 1];
+    current_nb_deliveries = _nb_deliveries[fwd_start - 1];
+  }
+
+  for (std::size_t i = fwd_start; i < route.size(); ++i) {
     switch (const auto& job = input.jobs[route[i]]; job.type) {
       using enum JOB_TYPE;
     case SINGLE:
@@ -102,13 +128,9 @@ void RawRoute::update_amounts(const Input& input) {
       current_nb_deliveries += 1;
       break;
     }
-    for (const auto tid : input.exclusive_tag_ids(route[i])) {
-      assert(tid < _exclusive_tag_counts.size());
-      _exclusive_tag_counts[tid] += 1;
-    }
-    _fwd_pickups[i] = current_pickups;
-    _fwd_deliveries[i] = current_deliveries;
-    _pd_loads[i] = current_pd_load;
+    _fwd_pickups.set(i, current_pickups);
+    _fwd_deliveries.set(i, current_deliveries);
+    _pd_loads.set(i, current_pd_load);
     assert(current_nb_deliveries <= current_nb_pickups);
     _nb_pickups[i] = current_nb_pickups;
     _nb_deliveries[i] = current_nb_deliveries;
@@ -118,16 +140,17 @@ void RawRoute::update_amounts(const Input& input) {
   current_deliveries = _zero;
   current_pickups = _zero;
 
-  _current_loads.back() = _fwd_pickups.back();
+  _current_loads.set(step_size - 1, _fwd_pickups.back());
   assert(_current_loads.back() <= capacity);
 
   for (std::size_t i = 0; i < route.size(); ++i) {
     auto bwd_i = route.size() - i - 1;
 
-    _bwd_deliveries[bwd_i] = current_deliveries;
-    _bwd_pickups[bwd_i] = current_pickups;
-    _current_loads[bwd_i + 1] =
-      _fwd_pickups[bwd_i] + _pd_loads[bwd_i] + current_deliveries;
+    _bwd_deliveries.set(bwd_i, current_deliveries);
+    _bwd_pickups.set(bwd_i, current_pickups);
+    _current_loads.set(bwd_i + 1,
+                       _fwd_pickups[bwd_i] + _pd_loads[bwd_i] +
+                         current_deliveries);
     assert(_current_loads[bwd_i + 1] <= capacity);
     const auto& job = input.jobs[route[bwd_i]];
     if (job.type == JOB_TYPE::SINGLE) {
@@ -135,41 +158,38 @@ void RawRoute::update_amounts(const Input& input) {
       current_pickups += job.pickup;
     }
   }
-  _current_loads[0] = current_deliveries;
+  _current_loads.set(0, current_deliveries);
   assert(_current_loads[0] <= capacity);
 
-  auto peak = _current_loads[0];
-  _fwd_peaks[0] = peak;
-  for (std::size_t s = 1; s < _fwd_peaks.size(); ++s) {
+  Amount peak(_current_loads[0]);
+  _fwd_peaks.set(0, peak);
+  for (std::size_t s = 1; s < step_size; ++s) {
     // Handle max component-wise.
+    const auto load = _current_loads[s];
     for (std::size_t r = 0; r < _zero.size(); ++r) {
-      peak[r] = std::max(peak[r], _current_loads[s][r]);
+      peak[r] = std::max(peak[r], load[r]);
     }
-    _fwd_peaks[s] = peak;
+    _fwd_peaks.set(s, peak);
   }
 
   peak = _current_loads.back();
-  _bwd_peaks.back() = peak;
-  for (std::size_t s = 1; s < _bwd_peaks.size(); ++s) {
-    auto bwd_s = _bwd_peaks.size() - s - 1;
+  _bwd_peaks.set(step_size - 1, peak);
+  for (std::size_t s = 1; s < step_size; ++s) {
+    auto bwd_s = step_size - s - 1;
     // Handle max component-wise.
+    const auto load = _current_loads[bwd_s];
     for (std::size_t r = 0; r < _zero.size(); ++r) {
-      peak[r] = std::max(peak[r], _current_loads[bwd_s][r]);
+      peak[r] = std::max(peak[r], load[r]);
     }
-    _bwd_peaks[bwd_s] = peak;
+    _bwd_peaks.set(bwd_s, peak);
   }
 
-  if (route.empty()) {
-    _delivery_margin = capacity;
-    _pickup_margin = capacity;
-  } else {
-    assert(!_fwd_pickups.empty());
-    const auto& pickups_sum = _fwd_pickups.back();
+  const auto init_load = _current_loads[0];
+  const auto pickups_sum = _fwd_pickups.back();
 
-    for (unsigned i = 0; i < _zero.size(); ++i) {
-      _delivery_margin[i] = capacity[i] - _current_loads[0][i];
-      _pickup_margin[i] = capacity[i] - pickups_sum[i];
-    }
+  for (unsigned i = 0; i < _zero.size(); ++i) {
+    _delivery_margin[i] = capacity[i] - init_load[i];
+    _pickup_margin[i] = capacity[i] - pickups_sum[i];
   }
 }
 
@@ -202,8 +222,8 @@ bool RawRoute::is_valid_addition_for_load(const Input&,
                                           const Index rank) const {
   assert(rank <= route.size());
 
-  const auto& load = route.empty() ? _zero : _current_loads[rank];
-  return load + pickup <= capacity;
+  // Loads are zero for empty routes.
+  return _current_loads[rank] + pickup <= capacity;
 }
 
 bool RawRoute::is_valid_addition_for_capacity_margins(
@@ -215,18 +235,20 @@ bool RawRoute::is_valid_addition_for_capacity_margins(
   assert(1 <= last_rank);
   assert(last_rank <= route.size() + 1);
 
-  const auto& first_deliveries =
+  const auto first_deliveries =
     (first_rank == 0) ? _current_loads[0] : _bwd_deliveries[first_rank - 1];
 
-  const auto& first_pickups =
-    (first_rank == 0) ? _zero : _fwd_pickups[first_rank - 1];
+  const Amount replaced_deliveries =
+    first_deliveries - _bwd_deliveries[last_rank - 1];
 
-  auto replaced_deliveries = first_deliveries - _bwd_deliveries[last_rank - 1];
+  Amount replaced_pickups(_fwd_pickups[last_rank - 1]);
+  if (first_rank != 0) {
+    replaced_pickups -= _fwd_pickups[first_rank - 1];
+  }
 
   return (_fwd_peaks[first_rank] + delivery <=
           capacity + replaced_deliveries) &&
-         (_bwd_peaks[last_rank] + pickup <=
-          capacity + _fwd_pickups[last_rank - 1] - first_pickups);
+         (_bwd_peaks[last_rank] + pickup <= capacity + replaced_pickups);
 }
 
 template <std::forward_iterator Iter>
@@ -340,18 +362,18 @@ bool RawRoute::is_valid_addition_for_capacity_inclusion(
     }
   }
 
-  const auto& init_load = (route.empty()) ? _zero : _current_loads[0];
+  // Loads are zero for empty routes.
+  const auto init_load = _current_loads[0];
 
-  const auto& first_deliveries =
+  const auto first_deliveries =
     (first_rank == 0) ? init_load : _bwd_deliveries[first_rank - 1];
 
-  const auto& last_deliveries =
+  const auto last_deliveries =
     (last_rank == 0) ? init_load : _bwd_deliveries[last_rank - 1];
 
-  auto replaced_deliveries = first_deliveries - last_deliveries;
+  const Amount replaced_deliveries = first_deliveries - last_deliveries;
 
-  delivery += ((route.empty()) ? _zero : _current_loads[first_rank]) -
-              replaced_deliveries;
+  delivery += _current_loads[first_rank] - replaced_deliveries;
 
   bool valid = (delivery <= capacity);
 
@@ -370,12 +392,14 @@ bool RawRoute::is_valid_addition_for_capacity_inclusion(
   return valid;
 }
 
-const Amount& RawRoute::job_deliveries_sum() const {
-  return route.empty() ? _zero : _current_loads[0];
+// Loads at route start and end are zero for empty routes, and match
+// deliveries and pickups sums otherwise.
+AmountView RawRoute::job_deliveries_sum() const {
+  return _current_loads[0];
 }
 
-const Amount& RawRoute::job_pickups_sum() const {
-  return route.empty() ? _zero : _fwd_pickups.back();
+AmountView RawRoute::job_pickups_sum() const {
+  return _current_loads.back();
 }
 
 const Amount& RawRoute::delivery_margin() const {
@@ -402,21 +426,21 @@ Amount RawRoute::delivery_in_range(Index i, Index j) const {
   if (i == j || route.empty()) {
     return _zero;
   }
-  const auto& before_deliveries =
+  const auto before_deliveries =
     (i == 0) ? _current_loads[0] : _bwd_deliveries[i - 1];
   return before_deliveries - _bwd_deliveries[j - 1];
 }
 
 void RawRoute::add(const Input& input, const Index job_rank, const Index rank) {
   route.insert(route.begin() + rank, job_rank);
-  update_amounts(input);
+  update_amounts(input, rank);
 }
 
 void RawRoute::remove(const Input& input,
                       const Index rank,
                       const unsigned count) {
   route.erase(route.begin() + rank, route.begin() + rank + count);
-  update_amounts(input);
+  update_amounts(input, rank);
 }
 
 template <std::forward_iterator Iter>
@@ -430,7 +454,7 @@ void RawRoute::replace(const Input& input,
   route.erase(route.begin() + first_rank, route.begin() + last_rank);
   route.insert(route.begin() + first_rank, first_job, last_job);
 
-  update_amounts(input);
+  update_amounts(input, first_rank);
 }
 
 template bool RawRoute::is_valid_addition_for_capacity_inclusion(
@@ -464,4 +488,9 @@ template void RawRoute::replace(const Input& input,
                                 std::vector<Index>::const_iterator last_job,
                                 const Index first_rank,
                                 const Index last_rank);
+template void RawRoute::replace(const Input& input,
+                                std::array<Index, 2>::const_iterator first_job,
+                                std::array<Index, 2>::const_iterator last_job,
+                                const Index first_rank,
+                                const Index last_rank);
 } // namespace vroom
@@ -10,6 +10,9 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <algorithm>
+#include <array>
+
 #include "structures/typedefs.h"
 #include "structures/vroom/input/input.h"
 
@@ -26,18 +29,22 @@ private:
   // the pinned workload already contains duplicates.
   std::vector<unsigned short> _exclusive_tag_limits;
 
+  // Load profiles are stored as flat AmountProfile buffers so that
+  // capacity checks read contiguous memory and updates don't
+  // allocate.
+
   // _fwd_pickups[i] (resp. _fwd_deliveries[i]) stores the total
   // pickups (resp. deliveries) for single jobs up to rank i.
-  std::vector<Amount> _fwd_pickups;
-  std::vector<Amount> _fwd_deliveries;
+  AmountProfile _fwd_pickups;
+  AmountProfile _fwd_deliveries;
 
   // _bwd_deliveries[i] (resp. _bwd_pickups[i]) stores the total
   // deliveries (resp. pickups) for single jobs pending after rank i.
-  std::vector<Amount> _bwd_deliveries;
-  std::vector<Amount> _bwd_pickups;
+  AmountProfile _bwd_deliveries;
+  AmountProfile _bwd_pickups;
 
   // _pd_loads[i] stores the shipments load at rank i (included).
-  std::vector<Amount> _pd_loads;
+  AmountProfile _pd_loads;
 
   // _nb_pickups[i] (resp. _nb_deliveries[i]) stores the number of
   // pickups (resp. deliveries) up to rank i.
@@ -47,26 +54,119 @@ private:
   // _current_loads[s] stores the vehicle load (taking all job types
   // into account) at *step* s (step 0 is the start, not the first job
   // rank).
-  std::vector<Amount> _current_loads;
+  AmountProfile _current_loads;
 
   // _fwd_peaks[s] stores the peak load (component-wise) up to *step*
   // s. _bwd_peaks[s] stores the peak load (component-wise) after
   // *step* s.
-  std::vector<Amount> _fwd_peaks;
-  std::vector<Amount> _bwd_peaks;
+  AmountProfile _fwd_peaks;
+  AmountProfile _bwd_peaks;
 
   // Store the difference between sum of single jobs deliveries
   // (resp. pickups) and vehicle capacity.
   Amount _delivery_margin;
   Amount _pickup_margin;
 
-protected:
-  const std::vector<unsigned short>& exclusive_tag_counts() const {
-    return _exclusive_tag_counts;
+  // Number of exclusive tags with value tid for jobs in [first_job;
+  // last_job), minus the number for jobs at ranks [first_rank;
+  // last_rank) in route.
+  template <std::forward_iterator Iter>
+  int exclusive_tag_delta(const Input& input,
+                          Index tid,
+                          Iter first_job,
+                          Iter last_job,
+                          Index first_rank,
+                          Index last_rank) const {
+    int delta = 0;
+    for (auto it = first_job; it != last_job; ++it) {
+      delta += std::ranges::count(input.exclusive_tag_ids(*it), tid);
+    }
+    for (Index r = first_rank; r < last_rank; ++r) {
+      delta -= std::ranges::count(input.exclusive_tag_ids(route[r]), tid);
+    }
+    return delta;
   }
 
-  const std::vector<unsigned short>& exclusive_tag_limits() const {
-    return _exclusive_tag_limits;
+protected:
+  // Check that including [first_job; last_job) in place of jobs at
+  // ranks [first_rank; last_rank) keeps all exclusive tag counts
+  // within limits.
+  template <std::forward_iterator Iter>
+  bool is_valid_addition_for_exclusive_tags(const Input& input,
+                                            Iter first_job,
+                                            Iter last_job,
+                                            Index first_rank,
+                                            Index last_rank) const {
+    if (_exclusive_tag_counts.empty()) {
+      return true;
+    }
+    last_rank = std::min(static_cast<Index>(route.size()), last_rank);
+    first_rank = std::min(first_rank, last_rank);
+
+    // Count changes for tags of inserted jobs, stored inline as there
+    // are usually only a few of them.
+    constexpr std::size_t MAX_INLINE_TAGS = 16;
+    std::array<std::pair<Index, int>, MAX_INLINE_TAGS> deltas;
+    std::size_t nb_tags = 0;
+
+    for (auto it = first_job; it != last_job; ++it) {
+      for (const auto tid : input.exclusive_tag_ids(*it)) {
+        const auto tags_end = deltas.begin() + nb_tags;
+        const auto search =
+          std::find_if(deltas.begin(), tags_end, [tid](const auto& d) {
+            return d.first == tid;
+          });
+        if (search != tags_end) {
+          ++search->second;
+          continue;
+        }
+
+        if (nb_tags == MAX_INLINE_TAGS) {
+          // Rare case with many tags in inserted range: compute count
+          // changes for each tag separately.
+          for (auto jt = first_job; jt != last_job; ++jt) {
+            for (const auto other_tid : input.exclusive_tag_ids(*jt)) {
+              if (_exclusive_tag_limits[other_tid] <
+                  _exclusive_tag_counts[other_tid] +
+                    exclusive_tag_delta(input,
+                                        other_tid,
+                                        first_job,
+                                        last_job,
+                                        first_rank,
+                                        last_rank)) {
+                return false;
+              }
+            }
+          }
+          return true;
+        }
+
+        deltas[nb_tags] = {tid, 1};
+        ++nb_tags;
+      }
+    }
+
+    if (nb_tags == 0) {
+      return true;
+    }
+
+    const auto tags_end = deltas.begin() + nb_tags;
+    for (Index r = first_rank; r < last_rank; ++r) {
+      for (const auto tid : input.exclusive_tag_ids(route[r])) {
+        const auto search =
+          std::find_if(deltas.begin(), tags_end, [tid](const auto& d) {
+            return d.first == tid;
+          });
+        if (search != tags_end) {
+          --search->second;
+        }
+      }
+    }
+
+    return std::all_of(deltas.begin(), tags_end, [this](const auto& d) {
+      return _exclusive_tag_counts[d.first] + d.second <=
+             _exclusive_tag_limits[d.first];
+    });
   }
 
 public:
@@ -90,7 +190,10 @@ public:
     return route.size();
   }
 
-  void update_amounts(const Input& input);
+  // Update load profiles after a route change. Profiles are assumed
+  // to still be valid for ranks before first_rank, where the route
+  // has not changed.
+  void update_amounts(const Input& input, Index first_rank = 0);
 
   bool has_pending_delivery_after_rank(Index rank) const;
 
@@ -98,15 +201,15 @@ public:
 
   bool has_pickup_up_to_rank(Index rank) const;
 
-  const Amount& fwd_peak(Index rank) const {
+  AmountView fwd_peak(Index rank) const {
     return _fwd_peaks[rank];
   }
 
-  const Amount& bwd_peak(Index rank) const {
+  AmountView bwd_peak(Index rank) const {
     return _bwd_peaks[rank];
   }
 
-  const Amount& max_load() const {
+  AmountView max_load() const {
     return _fwd_peaks.back();
   }
 
@@ -157,9 +260,9 @@ public:
                                                 Index first_rank,
                                                 Index last_rank) const;
 
-  const Amount& job_deliveries_sum() const;
+  AmountView job_deliveries_sum() const;
 
-  const Amount& job_pickups_sum() const;
+  AmountView job_pickups_sum() const;
 
   const Amount& delivery_margin() const;
 
@@ -170,23 +273,23 @@ public:
   Amount pickup_in_range(Index i, Index j) const;
   Amount delivery_in_range(Index i, Index j) const;
 
-  const Amount& bwd_deliveries(Index i) const {
+  AmountView bwd_deliveries(Index i) const {
     return _bwd_deliveries[i];
   }
 
-  const Amount& fwd_deliveries(Index i) const {
+  AmountView fwd_deliveries(Index i) const {
     return _fwd_deliveries[i];
   }
 
-  const Amount& bwd_pickups(Index i) const {
+  AmountView bwd_pickups(Index i) const {
     return _bwd_pickups[i];
   }
 
-  const Amount& fwd_pickups(Index i) const {
+  AmountView fwd_pickups(Index i) const {
     return _fwd_pickups[i];
   }
 
-  const Amount& load_at_step(Index s) const {
+  AmountView load_at_step(Index s) const {
     return _current_loads[s];
   }
 
@@ -266,64 +369,12 @@ public:
     const auto insert_len = static_cast<unsigned>(std::distance(first_job, last_job));
 
     // Exclusive tags: route membership constraint.
-    if (!_exclusive_tag_counts.empty()) {
-      // Collect tag ids present in the inserted range.
-      std::vector<Index> inserted_tag_ids;
-      for (auto it = first_job; it != last_job; ++it) {
-        const auto& tags = input.exclusive_tag_ids(*it);
-        inserted_tag_ids.insert(inserted_tag_ids.end(), tags.begin(), tags.end());
-      }
-
-      if (!inserted_tag_ids.empty()) {
-        std::ranges::sort(inserted_tag_ids);
-
-        // Unique tids + counts in inserted range.
-        std::vector<Index> inserted_unique_tids;
-        std::vector<unsigned short> inserted_counts;
-        for (std::size_t i = 0; i < inserted_tag_ids.size();) {
-          const auto tid = inserted_tag_ids[i];
-          std::size_t j = i + 1;
-          while (j < inserted_tag_ids.size() && inserted_tag_ids[j] == tid) {
-            ++j;
-          }
-          const auto c = static_cast<unsigned short>(j - i);
-          if (c > _exclusive_tag_limits[tid]) {
-            return false;
-          }
-          inserted_unique_tids.push_back(tid);
-          inserted_counts.push_back(c);
-          i = j;
-        }
-
-        // Count occurrences of those tids inside replaced segment.
-        std::vector<unsigned short> removed_counts(inserted_unique_tids.size(), 0);
-
-        const Index stop = std::min(static_cast<Index>(route.size()), last_rank);
-        for (Index r = std::min(first_rank, stop); r < stop; ++r) {
-          for (const auto tid : input.exclusive_tag_ids(route[r])) {
-            const auto lb = std::ranges::lower_bound(inserted_unique_tids, tid);
-            if (lb != inserted_unique_tids.end() && *lb == tid) {
-              const auto pos = static_cast<std::size_t>(
-                std::distance(inserted_unique_tids.begin(), lb));
-              removed_counts[pos] += 1;
-            }
-          }
-        }
-
-        for (std::size_t i = 0; i < inserted_unique_tids.size(); ++i) {
-          const auto tid = inserted_unique_tids[i];
-          const auto total = _exclusive_tag_counts[tid];
-          const auto removed = removed_counts[i];
-          const auto added = inserted_counts[i];
-          // Check resulting count <= limit.
-          const int new_total = static_cast<int>(total) -
-                                static_cast<int>(removed) +
-                                static_cast<int>(added);
-          if (new_total > static_cast<int>(_exclusive_tag_limits[tid])) {
-            return false;
-          }
-        }
-      }
+    if (!is_valid_addition_for_exclusive_tags(input,
+                                              first_job,
+                                              last_job,
+                                              first_rank,
+                                              last_rank)) {
+      return false;
     }
 
     // Enforce first-leg distance bound on head insertion for vehicles without pre-defined steps.
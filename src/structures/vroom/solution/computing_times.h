@@ -10,16 +10,40 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <optional>
+
 #include "structures/typedefs.h"
 
 namespace vroom {
 
+struct MatrixCacheStats {
+  // Number of matrices requests served from cache, served by only
+  // fetching missing values and not found in cache.
+  unsigned hits{0};
+  unsigned partial_hits{0};
+  unsigned misses{0};
+};
+
+struct MatricesTimes {
+  // Time spent computing matrices and part of it overlapped with
+  // input preprocessing, in milliseconds.
+  UserDuration duration{0};
+  UserDuration overlap{0};
+};
+
 struct ComputingTimes {
   // Computing times in milliseconds.
   UserDuration loading{0};
   UserDuration solving{0};
   UserDuration routing{0};
 
+  // Only set in solving mode when matrices are computed by a
+  // routing engine.
+  std::optional<MatricesTimes> matrices;
+
+  // Only set when using a matrix cache.
+  std::optional<MatrixCacheStats> matrix_cache;
+
   ComputingTimes();
 };
 
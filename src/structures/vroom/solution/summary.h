@@ -10,6 +10,8 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <optional>
+
 #include "structures/typedefs.h"
 #include "structures/vroom/amount.h"
 #include "structures/vroom/solution/computing_times.h"
@@ -34,6 +36,10 @@ struct Summary {
 
   Violations violations{0, 0};
 
+  // Number of input locations merged with another one based on
+  // coordinates precision, only set when one is provided.
+  std::optional<unsigned> merged_locations;
+
   Summary();
 
   Summary(unsigned routes, unsigned unassigned, const Amount& zero_amount);
@@ -18,10 +18,21 @@ namespace vroom::utils {
 SolutionState::SolutionState(const Input& input)
   : _input(input),
     _nb_vehicles(_input.vehicles.size()),
-    fwd_costs(_nb_vehicles, std::vector<std::vector<Eval>>(_nb_vehicles)),
-    bwd_costs(_nb_vehicles, std::vector<std::vector<Eval>>(_nb_vehicles)),
-    fwd_penalties(_nb_vehicles,
-                  std::vector<std::vector<Cost>>(_nb_vehicles)),
+    _granular(0 < _input.granular_routes_k() &&
+              _input.granular_routes_k() + 1 < _nb_vehicles),
+    _nb_granular_routes(_input.granular_routes_k()),
+    _routes(_nb_vehicles),
+    _route_centroids(_nb_vehicles),
+    _cost_classes(_nb_vehicles),
+    _penalty_classes(_nb_vehicles),
+    _fwd_costs(_nb_vehicles),
+    _bwd_costs(_nb_vehicles),
+    _fwd_penalties(_nb_vehicles),
+    _cheapest_job_rank_in_routes_from(_nb_vehicles),
+    _cheapest_job_rank_in_routes_to(_nb_vehicles),
+    _job_ranks_in_route(_input.jobs.size(), NO_RANK),
+    _invalidated(_nb_vehicles, false),
+    route_neighbours(_nb_vehicles),
     fwd_skill_rank(_nb_vehicles, std::vector<Index>(_nb_vehicles)),
     bwd_skill_rank(_nb_vehicles, std::vector<Index>(_nb_vehicles)),
     fwd_priority(_nb_vehicles),
@@ -35,18 +46,247 @@ SolutionState::SolutionState(const Input& input)
     pd_gains(_nb_vehicles),
     matching_delivery_rank(_nb_vehicles),
     matching_pickup_rank(_nb_vehicles),
-    cheapest_job_rank_in_routes_from(_nb_vehicles,
-                                     std::vector<std::vector<Index>>(
-                                       _nb_vehicles)),
-    cheapest_job_rank_in_routes_to(_nb_vehicles,
-                                   std::vector<std::vector<Index>>(
-                                     _nb_vehicles)),
     insertion_ranks_begin(_nb_vehicles),
     insertion_ranks_end(_nb_vehicles),
     weak_insertion_ranks_begin(_nb_vehicles),
     weak_insertion_ranks_end(_nb_vehicles),
     route_evals(_nb_vehicles),
     route_bbox(_nb_vehicles, BBox()) {
+  if (!_granular) {
+    // All routes are neighbours, once and for all.
+    std::vector<Index> all_vehicles(_nb_vehicles);
+    std::iota(all_vehicles.begin(), all_vehicles.end(), 0);
+    route_neighbours.assign(_nb_vehicles, all_vehicles);
+
+    std::vector<Index> all_cost_classes(_input.nb_cost_classes());
+    std::iota(all_cost_classes.begin(), all_cost_classes.end(), 0);
+    _cost_classes.assign(_nb_vehicles, all_cost_classes);
+
+    std::vector<Index> all_penalty_classes(_input.nb_penalty_classes());
+    std::iota(all_penalty_classes.begin(), all_penalty_classes.end(), 0);
+    _penalty_classes.assign(_nb_vehicles, all_penalty_classes);
+
+    for (std::size_t v = 0; v < _nb_vehicles; ++v) {
+      _cheapest_job_rank_in_routes_from[v].resize(_nb_vehicles);
+      _cheapest_job_rank_in_routes_to[v].resize(_nb_vehicles);
+    }
+  }
+}
+
+std::optional<std::size_t> SolutionState::neighbour_rank(Index v,
+                                                         Index new_v) const {
+  if (!_granular) {
+    return new_v;
+  }
+
+  const auto& neighbours = route_neighbours[v];
+  const auto search = std::ranges::lower_bound(neighbours, new_v);
+  if (search == neighbours.end() || *search != new_v) {
+    return std::nullopt;
+  }
+  return std::distance(neighbours.begin(), search);
+}
+
+std::optional<std::size_t>
+SolutionState::class_rank(const std::vector<Index>& classes, Index c) const {
+  if (!_granular) {
+    return c;
+  }
+
+  const auto search = std::ranges::lower_bound(classes, c);
+  if (search == classes.end() || *search != c) {
+    return std::nullopt;
+  }
+  return std::distance(classes.begin(), search);
+}
+
+Eval SolutionState::fwd_cost(Index v,
+                             Index new_v,
+                             Index first_rank,
+                             Index last_rank) const {
+  assert(first_rank <= last_rank);
+  assert(!_granular || last_rank < _routes[v].size());
+
+  if (const auto c =
+        class_rank(_cost_classes[v], _input.vehicle_cost_class(new_v));
+      c.has_value()) {
+    const auto& costs = _fwd_costs[v][c.value()];
+    return costs[last_rank] - costs[first_rank];
+  }
+  assert(_granular);
+
+  const auto& route = _routes[v];
+  const auto& vehicle = _input.vehicles[new_v];
+  Eval eval;
+  for (Index i = first_rank; i < last_rank; ++i) {
+    eval += vehicle.eval(_input.jobs[route[i]].index(),
+                         _input.jobs[route[i + 1]].index());
+  }
+  return eval;
+}
+
+Eval SolutionState::bwd_cost(Index v,
+                             Index new_v,
+                             Index first_rank,
+                             Index last_rank) const {
+  assert(first_rank <= last_rank);
+  assert(!_granular || last_rank < _routes[v].size());
+
+  if (const auto c =
+        class_rank(_cost_classes[v], _input.vehicle_cost_class(new_v));
+      c.has_value()) {
+    const auto& costs = _bwd_costs[v][c.value()];
+    return costs[last_rank] - costs[first_rank];
+  }
+  assert(_granular);
+
+  const auto& route = _routes[v];
+  const auto& vehicle = _input.vehicles[new_v];
+  Eval eval;
+  for (Index i = first_rank; i < last_rank; ++i) {
+    eval += vehicle.eval(_input.jobs[route[i + 1]].index(),
+                         _input.jobs[route[i]].index());
+  }
+  return eval;
+}
+
+Cost SolutionState::penalty_sum(Index v,
+                                Index new_v,
+                                Index first_rank,
+                                Index last_rank) const {
+  assert(first_rank <= last_rank);
+  assert(!_granular || last_rank <= _routes[v].size());
+
+  if (last_rank == first_rank) {
+    return 0;
+  }
+
+  if (const auto c =
+        class_rank(_penalty_classes[v], _input.vehicle_penalty_class(new_v));
+      c.has_value()) {
+    const auto& pref = _fwd_penalties[v][c.value()];
+    if (first_rank == 0) {
+      return pref[last_rank - 1];
+    }
+    return pref[last_rank - 1] - pref[first_rank - 1];
+  }
+  assert(_granular);
+
+  const auto& route = _routes[v];
+  Cost penalty = 0;
+  for (Index i = first_rank; i < last_rank; ++i) {
+    penalty += _input.job_vehicle_penalty(route[i], new_v);
+  }
+  return penalty;
+}
+
+Index SolutionState::cheapest_job_rank_in_routes_from(Index v1,
+                                                      Index v2,
+                                                      Index r1) const {
+  const auto k = neighbour_rank(v1, v2);
+  assert(k.has_value());
+  return _cheapest_job_rank_in_routes_from[v1][k.value()][r1];
+}
+
+Index SolutionState::cheapest_job_rank_in_routes_to(Index v1,
+                                                    Index v2,
+                                                    Index r1) const {
+  const auto k = neighbour_rank(v1, v2);
+  assert(k.has_value());
+  return _cheapest_job_rank_in_routes_to[v1][k.value()][r1];
+}
+
+bool SolutionState::has_range_costs(Index v, Index new_v) const {
+  return class_rank(_cost_classes[v], _input.vehicle_cost_class(new_v))
+           .has_value() &&
+         class_rank(_penalty_classes[v], _input.vehicle_penalty_class(new_v))
+           .has_value();
+}
+
+double SolutionState::route_distance(Index v1, Index v2) const {
+  if (_input.all_locations_have_coords()) {
+    const auto& c1 = _route_centroids[v1];
+    const auto& c2 = _route_centroids[v2];
+    const auto d_lon = c1.lon - c2.lon;
+    const auto d_lat = c1.lat - c2.lat;
+    return d_lon * d_lon + d_lat * d_lat;
+  }
+
+  // Without coordinates, use the cost between a job in the middle of
+  // each route, or vehicle start/end for empty routes.
+  const auto anchor = [this](Index v) {
+    const auto& route = _routes[v];
+    if (!route.empty()) {
+      return _input.jobs[route[route.size() / 2]].index();
+    }
+    const auto& vehicle = _input.vehicles[v];
+    return vehicle.has_start() ? vehicle.start.value().index()
+                               : vehicle.end.value().index();
+  };
+
+  return static_cast<double>(_input.vehicles[v1].cost(anchor(v1), anchor(v2)));
+}
+
+void SolutionState::store_route(const std::vector<Index>& route, Index v) {
+  _routes[v] = route;
+
+  if (_granular && _input.all_locations_have_coords()) {
+    auto& centroid = _route_centroids[v];
+    if (route.empty()) {
+      const auto& vehicle = _input.vehicles[v];
+      centroid = vehicle.has_start() ? vehicle.start.value().coordinates()
+                                     : vehicle.end.value().coordinates();
+    } else {
+      centroid = {0, 0};
+      for (const auto i : route) {
+        const auto& loc = _input.jobs[i].location;
+        centroid.lon += loc.lon();
+        centroid.lat += loc.lat();
+      }
+      centroid.lon /= route.size();
+      centroid.lat /= route.size();
+    }
+  }
+}
+
+void SolutionState::set_route_neighbours(Index v) {
+  assert(_granular);
+
+  std::vector<std::pair<double, Index>> candidates;
+  candidates.reserve(_nb_vehicles - 1);
+  for (Index other_v = 0; other_v < _nb_vehicles; ++other_v) {
+    if (other_v != v && _input.vehicle_ok_with_vehicle(v, other_v)) {
+      candidates.emplace_back(route_distance(v, other_v), other_v);
+    }
+  }
+
+  const auto nb_neighbours = std::min(_nb_granular_routes, candidates.size());
+  std::ranges::nth_element(candidates, candidates.begin() + nb_neighbours);
+
+  auto& neighbours = route_neighbours[v];
+  neighbours.clear();
+  neighbours.push_back(v);
+  for (std::size_t i = 0; i < nb_neighbours; ++i) {
+    neighbours.push_back(candidates[i].second);
+  }
+  std::ranges::sort(neighbours);
+
+  _cheapest_job_rank_in_routes_from[v].assign(neighbours.size(), {});
+  _cheapest_job_rank_in_routes_to[v].assign(neighbours.size(), {});
+
+  auto& cost_classes = _cost_classes[v];
+  auto& penalty_classes = _penalty_classes[v];
+  cost_classes.clear();
+  penalty_classes.clear();
+  for (const auto n : neighbours) {
+    cost_classes.push_back(_input.vehicle_cost_class(n));
+    penalty_classes.push_back(_input.vehicle_penalty_class(n));
+  }
+  for (auto* classes : {&cost_classes, &penalty_classes}) {
+    std::ranges::sort(*classes);
+    const auto [first, last] = std::ranges::unique(*classes);
+    classes->erase(first, last);
+  }
 }
 
 template <class Route> void SolutionState::setup(const Route& r, Index v) {
@@ -63,6 +303,13 @@ template <class Route> void SolutionState::setup(const Route& r, Index v) {
 }
 
 template <class Solution> void SolutionState::setup(const Solution& sol) {
+  if (_granular) {
+    // Picking neighbours for a route requires all routes to be known.
+    for (std::size_t v = 0; v < _nb_vehicles; ++v) {
+      store_route(sol[v].route, v);
+    }
+  }
+
   for (std::size_t v = 0; v < _nb_vehicles; ++v) {
     setup(sol[v], v);
   }
@@ -80,43 +327,89 @@ template <class Solution> void SolutionState::setup(const Solution& sol) {
   }
 }
 
+void SolutionState::invalidate(Index v) {
+  if (!_invalidated[v]) {
+    _invalidated[v] = true;
+    _invalidated_routes.push_back(v);
+  }
+}
+
+template <class Solution> void SolutionState::refresh(const Solution& sol) {
+  if (_granular) {
+    // Picking neighbours for a route requires all routes to be known.
+    for (const auto v : _invalidated_routes) {
+      store_route(sol[v].route, v);
+    }
+  }
+
+  for (const auto v : _invalidated_routes) {
+    const auto& route = sol[v].route;
+    update_route_bbox(route, v);
+    update_costs(route, v);
+    update_skills(route, v);
+    update_priorities(route, v);
+    set_node_gains(route, v);
+    set_edge_gains(route, v);
+    set_pd_matching_ranks(route, v);
+    set_pd_gains(route, v);
+
+    _invalidated[v] = false;
+  }
+  _invalidated_routes.clear();
+}
+
 void SolutionState::update_costs(const std::vector<Index>& route, Index v) {
-  fwd_costs[v] =
-    std::vector<std::vector<Eval>>(_nb_vehicles,
+  if (_granular) {
+    set_route_neighbours(v);
+  }
+
+  const auto& cost_classes = _cost_classes[v];
+  const auto nb_cost_classes = cost_classes.size();
+
+  _fwd_costs[v] =
+    std::vector<std::vector<Eval>>(nb_cost_classes,
                                    std::vector<Eval>(route.size()));
-  bwd_costs[v] =
-    std::vector<std::vector<Eval>>(_nb_vehicles,
+  _bwd_costs[v] =
+    std::vector<std::vector<Eval>>(nb_cost_classes,
                                    std::vector<Eval>(route.size()));
-  fwd_penalties[v] =
-    std::vector<std::vector<Cost>>(_nb_vehicles,
-                                   std::vector<Cost>(route.size(), 0));
 
-  Index previous_index = 0; // dummy init
-  if (!route.empty()) {
-    previous_index = _input.jobs[route[0]].index();
-    for (Index v_rank = 0; v_rank < _nb_vehicles; ++v_rank) {
-      fwd_costs[v][v_rank][0] = Eval();
-      bwd_costs[v][v_rank][0] = Eval();
-      fwd_penalties[v][v_rank][0] =
-        _input.job_vehicle_penalty(route[0], v_rank);
+  for (std::size_t c = 0; c < nb_cost_classes; ++c) {
+    const auto& vehicle =
+      _input.vehicles[_input.cost_class_vehicle(cost_classes[c])];
+    auto& fwd_costs = _fwd_costs[v][c];
+    auto& bwd_costs = _bwd_costs[v][c];
+
+    Index previous_index = 0; // dummy init
+    if (!route.empty()) {
+      previous_index = _input.jobs[route[0]].index();
+    }
+
+    for (std::size_t i = 1; i < route.size(); ++i) {
+      const auto current_index = _input.jobs[route[i]].index();
+      fwd_costs[i] =
+        fwd_costs[i - 1] + vehicle.eval(previous_index, current_index);
+      bwd_costs[i] =
+        bwd_costs[i - 1] + vehicle.eval(current_index, previous_index);
+      previous_index = current_index;
     }
   }
 
-  for (std::size_t i = 1; i < route.size(); ++i) {
-    const auto current_index = _input.jobs[route[i]].index();
-    for (Index v_rank = 0; v_rank < _nb_vehicles; ++v_rank) {
-      const auto& other_v = _input.vehicles[v_rank];
-      fwd_costs[v][v_rank][i] = fwd_costs[v][v_rank][i - 1] +
-                                other_v.eval(previous_index, current_index);
+  const auto& penalty_classes = _penalty_classes[v];
+  const auto nb_penalty_classes = penalty_classes.size();
+
+  _fwd_penalties[v] =
+    std::vector<std::vector<Cost>>(nb_penalty_classes,
+                                   std::vector<Cost>(route.size(), 0));
 
-      bwd_costs[v][v_rank][i] = bwd_costs[v][v_rank][i - 1] +
-                                other_v.eval(current_index, previous_index);
+  for (std::size_t c = 0; c < nb_penalty_classes; ++c) {
+    const auto v_rank = _input.penalty_class_vehicle(penalty_classes[c]);
+    auto& fwd_penalties = _fwd_penalties[v][c];
 
-      fwd_penalties[v][v_rank][i] =
-        fwd_penalties[v][v_rank][i - 1] +
-        _input.job_vehicle_penalty(route[i], v_rank);
+    Cost penalty = 0;
+    for (std::size_t i = 0; i < route.size(); ++i) {
+      penalty += _input.job_vehicle_penalty(route[i], v_rank);
+      fwd_penalties[i] = penalty;
     }
-    previous_index = current_index;
   }
 }
 
@@ -632,39 +925,102 @@ void SolutionState::set_insertion_ranks(const TWRoute& tw_r, Index v) {
   }
 }
 
+std::optional<Index>
+SolutionState::get_cheapest_rank_from_nearest(Index v,
+                                              Index j,
+                                              bool from) const {
+  const auto& vehicle = _input.vehicles[v];
+  const auto cost_class = _input.vehicle_cost_class(v);
+  const auto nearest = from ? _input.nearest_jobs_from(cost_class, j)
+                            : _input.nearest_jobs_to(cost_class, j);
+  const auto j_index = _input.jobs[j].index();
+
+  std::optional<Index> best_rank;
+  Cost best_cost = 0;
+  for (const auto other : nearest) {
+    const auto rank = _job_ranks_in_route[other];
+    if (!best_rank.has_value() && rank == NO_RANK) {
+      continue;
+    }
+
+    const auto other_index = _input.jobs[other].index();
+    const auto cost = from ? vehicle.cost(j_index, other_index)
+                           : vehicle.cost(other_index, j_index);
+    if (!best_rank.has_value()) {
+      best_rank = rank;
+      best_cost = cost;
+      continue;
+    }
+
+    if (best_cost < cost) {
+      return best_rank;
+    }
+    // Same cost, lower rank wins as with a full scan.
+    if (rank != NO_RANK) {
+      best_rank = std::min(best_rank.value(), rank);
+    }
+  }
+
+  // Jobs with the same cost may follow in a truncated list.
+  return (nearest.size() + 1 == _input.jobs.size()) ? best_rank
+                                                    : std::nullopt;
+}
+
 void SolutionState::update_cheapest_job_rank_in_routes(
   const std::vector<Index>& route_1,
   const std::vector<Index>& route_2,
   Index v1,
   Index v2) {
-  cheapest_job_rank_in_routes_from[v1][v2].assign(route_1.size(), 0);
-  cheapest_job_rank_in_routes_to[v1][v2].assign(route_1.size(), 0);
+  const auto k = neighbour_rank(v1, v2);
+  assert(k.has_value());
+  auto& cheapest_from = _cheapest_job_rank_in_routes_from[v1][k.value()];
+  auto& cheapest_to = _cheapest_job_rank_in_routes_to[v1][k.value()];
+  cheapest_from.assign(route_1.size(), 0);
+  cheapest_to.assign(route_1.size(), 0);
+
+  for (std::size_t r2 = 0; r2 < route_2.size(); ++r2) {
+    _job_ranks_in_route[route_2[r2]] = r2;
+  }
+
+  const auto& vehicle = _input.vehicles[v2];
 
   for (std::size_t r1 = 0; r1 < route_1.size(); ++r1) {
     const Index index_r1 = _input.jobs[route_1[r1]].index();
 
+    // Nearest jobs lists usually tell cheapest ranks without
+    // scanning route_2.
+    const auto nearest_from_rank =
+      get_cheapest_rank_from_nearest(v2, route_1[r1], true);
+    const auto nearest_to_rank =
+      get_cheapest_rank_from_nearest(v2, route_1[r1], false);
+
     auto min_from = std::numeric_limits<Cost>::max();
     auto min_to = std::numeric_limits<Cost>::max();
     Index best_from_rank = 0;
     Index best_to_rank = 0;
 
-    const auto& vehicle = _input.vehicles[v2];
-    for (std::size_t r2 = 0; r2 < route_2.size(); ++r2) {
-      const Index index_r2 = _input.jobs[route_2[r2]].index();
-      if (const auto cost_from = vehicle.cost(index_r1, index_r2);
-          cost_from < min_from) {
-        min_from = cost_from;
-        best_from_rank = r2;
-      }
-      const auto cost_to = vehicle.cost(index_r2, index_r1);
-      if (cost_to < min_to) {
-        min_to = cost_to;
-        best_to_rank = r2;
+    if (!nearest_from_rank.has_value() || !nearest_to_rank.has_value()) {
+      for (std::size_t r2 = 0; r2 < route_2.size(); ++r2) {
+        const Index index_r2 = _input.jobs[route_2[r2]].index();
+        if (const auto cost_from = vehicle.cost(index_r1, index_r2);
+            cost_from < min_from) {
+          min_from = cost_from;
+          best_from_rank = r2;
+        }
+        const auto cost_to = vehicle.cost(index_r2, index_r1);
+        if (cost_to < min_to) {
+          min_to = cost_to;
+          best_to_rank = r2;
+        }
       }
     }
 
-    cheapest_job_rank_in_routes_from[v1][v2][r1] = best_from_rank;
-    cheapest_job_rank_in_routes_to[v1][v2][r1] = best_to_rank;
+    cheapest_from[r1] = nearest_from_rank.value_or(best_from_rank);
+    cheapest_to[r1] = nearest_to_rank.value_or(best_to_rank);
+  }
+
+  for (const auto j : route_2) {
+    _job_ranks_in_route[j] = NO_RANK;
   }
 }
 
@@ -704,4 +1060,7 @@ void SolutionState::update_route_bbox(const std::vector<Index>& route,
 template void SolutionState::setup(const std::vector<RawRoute>&);
 template void SolutionState::setup(const std::vector<TWRoute>&);
 
+template void SolutionState::refresh(const std::vector<RawRoute>&);
+template void SolutionState::refresh(const std::vector<TWRoute>&);
+
 } // namespace vroom::utils
@@ -22,24 +22,91 @@ private:
   const Input& _input;
   const std::size_t _nb_vehicles;
 
+  // Granular mode is used when only a subset of other routes is
+  // kept in route_neighbours.
+  const bool _granular;
+  const std::size_t _nb_granular_routes;
+
+  // Routes as of last call to setup or refresh, only stored in
+  // granular mode to pick neighbours and compute costs on demand for
+  // vehicles that are not in route_neighbours.
+  std::vector<std::vector<Index>> _routes;
+
+  // Route centroids, only used to pick neighbours in granular mode
+  // when all locations have coordinates.
+  std::vector<Coordinates> _route_centroids;
+
+  // _cost_classes[v] (resp. _penalty_classes[v]) lists in increasing
+  // order the cost classes (resp. penalty classes) of vehicles in
+  // route_neighbours[v].
+  std::vector<std::vector<Index>> _cost_classes;
+  std::vector<std::vector<Index>> _penalty_classes;
+
+  // _fwd_costs[v][c][i] stores the total cost from job at rank 0 to
+  // job at rank i in the route for vehicle v, from the point of view
+  // of any vehicle in cost class _cost_classes[v][c].
+  // _bwd_costs[v][c][i] stores the total cost from job at rank i to
+  // job at rank 0 (i.e. when *reversing* all edges) in the route for
+  // vehicle v, from the point of view of the same vehicles.
+  std::vector<std::vector<std::vector<Eval>>> _fwd_costs;
+  std::vector<std::vector<std::vector<Eval>>> _bwd_costs;
+
+  // _fwd_penalties[v][c][i] stores the sum of per-job objective
+  // penalties from job at rank 0 to job at rank i (included) in the
+  // route for vehicle v, from the point of view of any vehicle in
+  // penalty class _penalty_classes[v][c] (penalties depend on
+  // assignment vehicle only, not on travel direction).
+  std::vector<std::vector<std::vector<Cost>>> _fwd_penalties;
+
+  // _cheapest_job_rank_in_routes_from[v1][k][r1] stores the rank of
+  // job in route v2 = route_neighbours[v1][k] that minimize cost (as
+  // seen from the v2 perspective) from job at rank r1 in v1.
+  std::vector<std::vector<std::vector<Index>>>
+    _cheapest_job_rank_in_routes_from;
+  // _cheapest_job_rank_in_routes_to[v1][k][r1] stores the rank of job
+  // in route v2 = route_neighbours[v1][k] that minimize cost (as seen
+  // from the v2 perspective) to job at rank r1 in v1.
+  std::vector<std::vector<std::vector<Index>>> _cheapest_job_rank_in_routes_to;
+
+  // Rank of each job in the route scanned in
+  // update_cheapest_job_rank_in_routes, NO_RANK for other jobs.
+  static constexpr Index NO_RANK = std::numeric_limits<Index>::max();
+  std::vector<Index> _job_ranks_in_route;
+
+  // Routes flagged by invalidate since last call to refresh, in
+  // flagging order.
+  std::vector<Index> _invalidated_routes;
+  std::vector<bool> _invalidated;
+
+  // Cheapest rank in route from (resp. to) job j based on nearest
+  // jobs, if it can be told from nearest jobs only.
+  std::optional<Index> get_cheapest_rank_from_nearest(Index v,
+                                                      Index j,
+                                                      bool from) const;
+
+  // Rank of new_v in route_neighbours[v], if any.
+  std::optional<std::size_t> neighbour_rank(Index v, Index new_v) const;
+
+  // Rank of class c in classes, if any.
+  std::optional<std::size_t> class_rank(const std::vector<Index>& classes,
+                                        Index c) const;
+
+  double route_distance(Index v1, Index v2) const;
+
+  void store_route(const std::vector<Index>& route, Index v);
+
+  void set_route_neighbours(Index v);
+
 public:
   // Store unassigned jobs.
   std::unordered_set<Index> unassigned;
 
-  // fwd_costs[v][new_v][i] stores the total cost from job at rank 0
-  // to job at rank i in the route for vehicle v, from the point of
-  // view of a vehicle new_v. bwd_costs[v][new_v][i] stores the total
-  // cost from job at rank i to job at rank 0 (i.e. when *reversing*
-  // all edges) in the route for vehicle v, from the point of view of
-  // a vehicle new_v.
-  std::vector<std::vector<std::vector<Eval>>> fwd_costs;
-  std::vector<std::vector<std::vector<Eval>>> bwd_costs;
-
-  // fwd_penalties[v][new_v][i] stores the sum of per-job objective penalties
-  // from job at rank 0 to job at rank i (included) in the route for vehicle v,
-  // from the point of view of vehicle new_v (penalties depend on assignment
-  // vehicle only, not on travel direction).
-  std::vector<std::vector<std::vector<Cost>>> fwd_penalties;
+  // route_neighbours[v] lists (in increasing order) v and the ranks
+  // of the other vehicles for which cost tables related to route for
+  // vehicle v are stored. This is all vehicles unless granular mode
+  // is used, in which case only the nearest compatible routes are
+  // kept and other costs are computed on demand.
+  std::vector<std::vector<Index>> route_neighbours;
 
   // fwd_skill_rank[v1][v2] stores the maximum rank r for a step in
   // route for vehicle v1 such that v2 can handle all jobs from step 0
@@ -90,15 +157,6 @@ public:
   std::vector<std::vector<Index>> matching_delivery_rank;
   std::vector<std::vector<Index>> matching_pickup_rank;
 
-  // cheapest_job_rank_in_routes_from[v1][v2][r1] stores the rank of
-  // job in route v2 that minimize cost (as seen from the v2
-  // perspective) from job at rank r1 in v1.
-  std::vector<std::vector<std::vector<Index>>> cheapest_job_rank_in_routes_from;
-  // cheapest_job_rank_in_routes_to[v1][v2][r1] stores the rank of job
-  // in route v2 that minimize cost (as seen from the v2 perspective)
-  // to job at rank r1 in v1.
-  std::vector<std::vector<std::vector<Index>>> cheapest_job_rank_in_routes_to;
-
   // insertion_ranks_begin[v][j] is the highest rank in route for
   // vehicle v such that inserting job at rank j strictly before
   // insertion_ranks_begin[v][j] is bound to fail based on job
@@ -133,10 +191,40 @@ public:
 
   explicit SolutionState(const Input& input);
 
+  // Cost for vehicle new_v to go through jobs from rank first_rank
+  // to rank last_rank in route for vehicle v, either in route order
+  // (fwd_cost) or reversed (bwd_cost).
+  Eval fwd_cost(Index v, Index new_v, Index first_rank, Index last_rank) const;
+  Eval bwd_cost(Index v, Index new_v, Index first_rank, Index last_rank) const;
+
+  // Sum of objective penalties for vehicle new_v of jobs in the
+  // [first_rank, last_rank) range in route for vehicle v.
+  Cost penalty_sum(Index v,
+                   Index new_v,
+                   Index first_rank,
+                   Index last_rank) const;
+
+  // Whether fwd_cost, bwd_cost and penalty_sum for route v and
+  // vehicle new_v are read from stored tables rather than computed
+  // on demand. Always true unless granular mode is used.
+  bool has_range_costs(Index v, Index new_v) const;
+
+  Index cheapest_job_rank_in_routes_from(Index v1, Index v2, Index r1) const;
+  Index cheapest_job_rank_in_routes_to(Index v1, Index v2, Index r1) const;
+
   template <class Route> void setup(const Route& r, Index v);
 
   template <class Solution> void setup(const Solution& sol);
 
+  // Flag route for vehicle v as modified. Data only used when looking
+  // for moves (bbox, costs, skills, priorities, node and edge gains,
+  // pickup and delivery ranks and gains) is then only recomputed upon
+  // next call to refresh, while route evaluation and insertion ranks
+  // are expected to be updated right away by the caller.
+  void invalidate(Index v);
+
+  template <class Solution> void refresh(const Solution& sol);
+
   void update_costs(const std::vector<Index>& route, Index v);
 
   void update_skills(const std::vector<Index>& route, Index v1);
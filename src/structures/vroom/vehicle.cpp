@@ -152,6 +152,11 @@ bool Vehicle::has_same_profile(const Vehicle& other) const {
          this->cost_wrapper.has_same_variable_costs(other.cost_wrapper);
 }
 
+bool Vehicle::has_same_evals(const Vehicle& other) const {
+  return (this->profile == other.profile) &&
+         this->cost_wrapper.has_same_evals(other.cost_wrapper);
+}
+
 bool Vehicle::cost_based_on_metrics() const {
   return cost_wrapper.cost_based_on_metrics();
 }
@@ -106,6 +106,8 @@ struct Vehicle {
 
   bool has_same_profile(const Vehicle& other) const;
 
+  bool has_same_evals(const Vehicle& other) const;
+
   bool cost_based_on_metrics() const;
 
   Duration available_duration() const;
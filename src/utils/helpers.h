@@ -212,16 +212,10 @@ inline Cost penalty_sum_for_range(const SolutionState& sol_state,
                                  Index target_vehicle,
                                  Index first_rank,
                                  Index last_rank) {
-  assert(first_rank <= last_rank);
-  if (last_rank == first_rank) {
-    return 0;
-  }
-  assert(last_rank <= sol_state.fwd_penalties[route_vehicle][target_vehicle].size());
-  const auto& pref = sol_state.fwd_penalties[route_vehicle][target_vehicle];
-  if (first_rank == 0) {
-    return pref[last_rank - 1];
-  }
-  return pref[last_rank - 1] - pref[first_rank - 1];
+  return sol_state.penalty_sum(route_vehicle,
+                               target_vehicle,
+                               first_rank,
+                               last_rank);
 }
 
 inline auto get_indices(const Input& input,
@@ -273,8 +267,7 @@ inline Eval get_range_removal_gain(const SolutionState& sol_state,
 
   if (last_rank > first_rank) {
     // Gain related to removed portion.
-    removal_gain += sol_state.fwd_costs[v][v][last_rank - 1];
-    removal_gain -= sol_state.fwd_costs[v][v][first_rank];
+    removal_gain += sol_state.fwd_cost(v, v, first_rank, last_rank - 1);
     // Removing jobs also removes their per-vehicle penalties (objective-only).
     removal_gain.cost +=
       penalty_sum_for_range(sol_state, v, v, first_rank, last_rank);
@@ -317,11 +310,15 @@ addition_cost_delta(const Input& input,
   Eval straight_delta;
   Eval reversed_delta;
   if (insertion_start != insertion_end) {
-    straight_delta += sol_state.fwd_costs[v2_rank][v1_rank][insertion_start];
-    straight_delta -= sol_state.fwd_costs[v2_rank][v1_rank][insertion_end - 1];
+    straight_delta -= sol_state.fwd_cost(v2_rank,
+                                         v1_rank,
+                                         insertion_start,
+                                         insertion_end - 1);
 
-    reversed_delta += sol_state.bwd_costs[v2_rank][v1_rank][insertion_start];
-    reversed_delta -= sol_state.bwd_costs[v2_rank][v1_rank][insertion_end - 1];
+    reversed_delta -= sol_state.bwd_cost(v2_rank,
+                                         v1_rank,
+                                         insertion_start,
+                                         insertion_end - 1);
   }
 
   // Penalties for inserted range depend on target vehicle v1_rank, but not on
@@ -466,6 +463,32 @@ inline Eval removal_cost_delta(const Input& input,
                                          0));
 }
 
+// Whether placing jobs first_job to last_job (in any direction) in
+// route for vehicle v in place of the [begin_rank, end_rank) range
+// creates an arc between granular neighbours. Placements next to
+// route start or end are always considered.
+inline bool is_granular_placement(const Input& input,
+                                  Index v,
+                                  const std::vector<Index>& route,
+                                  Index begin_rank,
+                                  Index end_rank,
+                                  Index first_job,
+                                  Index last_job) {
+  if (input.granular_jobs_k() == 0 || begin_rank == 0 ||
+      end_rank == route.size()) {
+    return true;
+  }
+
+  const auto before = route[begin_rank - 1];
+  const auto after = route[end_rank];
+
+  return input.is_granular_arc(v, before, first_job) ||
+         input.is_granular_arc(v, last_job, after) ||
+         (first_job != last_job &&
+          (input.is_granular_arc(v, before, last_job) ||
+           input.is_granular_arc(v, first_job, after)));
+}
+
 inline Eval max_edge_eval(const Input& input,
                           const Vehicle& v,
                           const std::vector<Index>& route) {
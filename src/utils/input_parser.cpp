@@ -26,6 +26,11 @@ inline Coordinates parse_coordinates(const rapidjson::Value& object,
   return {object[key][0].GetDouble(), object[key][1].GetDouble()};
 }
 
+// Index values have to fit in Index, max value being reserved.
+inline bool is_valid_index(const rapidjson::Value& value) {
+  return value.IsUint() && value.GetUint() < MAX_INDEX_SIZE;
+}
+
 inline std::string get_string(const rapidjson::Value& object, const char* key) {
   std::string value;
   if (object.HasMember(key)) {
@@ -535,7 +540,7 @@ inline Vehicle get_vehicle(const rapidjson::Value& json_vehicle,
   // optional start location.
   const bool has_start_coords = json_vehicle.HasMember("start");
   const bool has_start_index = json_vehicle.HasMember("start_index");
-  if (has_start_index && !json_vehicle["start_index"].IsUint()) {
+  if (has_start_index && !is_valid_index(json_vehicle["start_index"])) {
     throw InputException(
       std::format("Invalid start_index for vehicle {}.", v_id));
   }
@@ -559,7 +564,7 @@ inline Vehicle get_vehicle(const rapidjson::Value& json_vehicle,
   // optional end location.
   const bool has_end_coords = json_vehicle.HasMember("end");
   const bool has_end_index = json_vehicle.HasMember("end_index");
-  if (has_end_index && !json_vehicle["end_index"].IsUint()) {
+  if (has_end_index && !is_valid_index(json_vehicle["end_index"])) {
     throw InputException(
       std::format("Invalid end_index for vehicle {}.", v_id));
   }
@@ -610,7 +615,7 @@ inline Location get_task_location(const rapidjson::Value& v,
   // Check what info are available to build task location.
   const bool has_location_coords = v.HasMember("location");
   const bool has_location_index = v.HasMember("location_index");
-  if (has_location_index && !v["location_index"].IsUint()) {
+  if (has_location_index && !is_valid_index(v["location_index"])) {
     throw InputException(std::format("Invalid location_index for {} {}.",
                                      task_type,
                                      v["id"].GetUint64()));
@@ -740,6 +745,19 @@ void parse(Input& input, const std::string& input_str, bool geometry) {
     }
     input.set_budget_densify_candidates_k(json_input["budget_densify_candidates_k"].GetUint());
   }
+  // Optional granular local search setting
+  if (json_input.HasMember("granular_routes_k")) {
+    if (!json_input["granular_routes_k"].IsUint()) {
+      throw InputException("Invalid granular_routes_k value.");
+    }
+    input.set_granular_routes_k(json_input["granular_routes_k"].GetUint());
+  }
+  if (json_input.HasMember("granular_jobs_k")) {
+    if (!json_input["granular_jobs_k"].IsUint()) {
+      throw InputException("Invalid granular_jobs_k value.");
+    }
+    input.set_granular_jobs_k(json_input["granular_jobs_k"].GetUint());
+  }
 
   // Optional exclusive tag pinned-conflict policy
   if (json_input.HasMember("exclusive_tags_allow_pinned_conflicts")) {
@@ -0,0 +1,162 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/exception.h"
+#include "utils/matrix_file.h"
+
+namespace vroom::io {
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC = {'V', 'R', 'O', 'O', 'M', 'M', 'T', 'X'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+constexpr std::size_t VERSION_OFFSET = 8;
+constexpr std::size_t TYPE_OFFSET = 12;
+constexpr std::size_t SIZE_OFFSET = 16;
+constexpr std::size_t PROFILE_OFFSET = 24;
+constexpr std::size_t PROFILE_SIZE = 40;
+constexpr std::size_t HEADER_SIZE = PROFILE_OFFSET + PROFILE_SIZE;
+
+template <class U> U read_value(const char* data) {
+  U value;
+  std::memcpy(&value, data, sizeof(U));
+  return value;
+}
+
+template <class U> void write_value(char* data, U value) {
+  std::memcpy(data, &value, sizeof(U));
+}
+
+void check_endianness() {
+  if constexpr (std::endian::native != std::endian::little) {
+    throw InputException("Binary matrix files require a little-endian host.");
+  }
+}
+
+} // namespace
+
+MatrixFile map_matrix_file(const std::string& file_path) {
+  check_endianness();
+
+  const int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw InputException("Can't read matrix file: " + file_path);
+  }
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) == -1) {
+    ::close(fd);
+    throw InputException("Can't read matrix file: " + file_path);
+  }
+
+  const auto file_size = static_cast<std::size_t>(file_stat.st_size);
+  if (file_size < HEADER_SIZE) {
+    ::close(fd);
+    throw InputException("Invalid matrix file: " + file_path);
+  }
+
+  // Read-only mapping, pages being shared with the page cache. Matrix
+  // copies values before any write.
+  void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw InputException("Can't map matrix file: " + file_path);
+  }
+
+  const std::shared_ptr<char> data(static_cast<char*>(mapping),
+                                   [file_size](char* p) {
+                                     ::munmap(p, file_size);
+                                   });
+
+  if (!std::equal(MAGIC.begin(), MAGIC.end(), data.get()) ||
+      read_value<uint32_t>(data.get() + VERSION_OFFSET) != FORMAT_VERSION) {
+    throw InputException("Invalid matrix file: " + file_path);
+  }
+
+  const auto type = read_value<uint32_t>(data.get() + TYPE_OFFSET);
+  if (type > static_cast<uint32_t>(MATRIX_TYPE::COSTS)) {
+    throw InputException("Invalid matrix type in file: " + file_path);
+  }
+
+  const auto n = read_value<uint64_t>(data.get() + SIZE_OFFSET);
+  const auto nb_values = (file_size - HEADER_SIZE) / sizeof(MatrixFileValue);
+  if (n == 0 || n > std::numeric_limits<uint32_t>::max() ||
+      (file_size - HEADER_SIZE) % sizeof(MatrixFileValue) != 0 ||
+      n * n != nb_values) {
+    throw InputException("Invalid matrix size in file: " + file_path);
+  }
+
+  const char* profile_begin = data.get() + PROFILE_OFFSET;
+  std::string profile(profile_begin,
+                      std::find(profile_begin,
+                                profile_begin + PROFILE_SIZE,
+                                '\0'));
+  if (profile.empty()) {
+    profile = DEFAULT_PROFILE;
+  }
+
+  // Values start right after the header, which keeps them aligned
+  // with regard to the page-aligned mapping.
+  std::shared_ptr<const MatrixFileValue>
+    values(data,
+           reinterpret_cast<const MatrixFileValue*>(data.get() + HEADER_SIZE));
+
+  return {std::move(profile),
+          static_cast<MATRIX_TYPE>(type),
+          Matrix<MatrixFileValue>(n, std::move(values))};
+}
+
+void write_matrix_file(const std::string& file_path,
+                       const std::string& profile,
+                       MATRIX_TYPE type,
+                       const Matrix<MatrixFileValue>& matrix) {
+  check_endianness();
+
+  if (profile.size() > PROFILE_SIZE) {
+    throw InputException("Profile name too long for matrix file: " + profile);
+  }
+
+  std::array<char, HEADER_SIZE> header{};
+  std::ranges::copy(MAGIC, header.begin());
+  write_value<uint32_t>(header.data() + VERSION_OFFSET, FORMAT_VERSION);
+  write_value<uint32_t>(header.data() + TYPE_OFFSET,
+                        static_cast<uint32_t>(type));
+  write_value<uint64_t>(header.data() + SIZE_OFFSET, matrix.size());
+  std::ranges::copy(profile, header.begin() + PROFILE_OFFSET);
+
+  std::ofstream out(file_path, std::ios::binary);
+  if (!out) {
+    throw InputException("Can't write matrix file: " + file_path);
+  }
+
+  out.write(header.data(), header.size());
+  for (std::size_t i = 0; i < matrix.size(); ++i) {
+    out.write(reinterpret_cast<const char*>(matrix[i]),
+              matrix.size() * sizeof(MatrixFileValue));
+  }
+
+  if (!out) {
+    throw InputException("Can't write matrix file: " + file_path);
+  }
+}
+
+} // namespace vroom::io
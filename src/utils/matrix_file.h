@@ -0,0 +1,50 @@
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <string>
+
+#include "structures/generic/matrix.h"
+
+namespace vroom::io {
+
+// Binary matrix files hold a 64-byte header followed by n * n
+// row-major uint32 values, all integers being little-endian:
+// - 8 bytes: "VROOMMTX" magic string;
+// - uint32: format version;
+// - uint32: matrix type (see MATRIX_TYPE);
+// - uint64: matrix size n;
+// - 40 bytes: profile name, padded with '\0'.
+enum class MATRIX_TYPE : uint32_t { DURATIONS, DISTANCES, COSTS };
+
+static_assert(std::is_same_v<UserDuration, UserDistance> &&
+                std::is_same_v<UserDuration, UserCost>,
+              "Binary matrix files use the same type for all matrices.");
+using MatrixFileValue = UserDuration;
+
+struct MatrixFile {
+  std::string profile;
+  MATRIX_TYPE type;
+  Matrix<MatrixFileValue> matrix;
+};
+
+// Map file in memory, the returned matrix being a view on mapped
+// values that keeps the mapping alive.
+MatrixFile map_matrix_file(const std::string& file_path);
+
+void write_matrix_file(const std::string& file_path,
+                       const std::string& profile,
+                       MATRIX_TYPE type,
+                       const Matrix<MatrixFileValue>& matrix);
+
+} // namespace vroom::io
+
+#endif
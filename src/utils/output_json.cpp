@@ -7,10 +7,12 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
-#include "../include/rapidjson/include/rapidjson/stringbuffer.h"
+#include "../include/rapidjson/include/rapidjson/ostreamwrapper.h"
 #include "../include/rapidjson/include/rapidjson/writer.h"
 
 #include "structures/typedefs.h"
@@ -18,384 +20,537 @@ All rights reserved (see LICENSE).
 
 namespace vroom::io {
 
-inline rapidjson::Value
-get_violations(const Violations& violations,
-               rapidjson::Document::AllocatorType& allocator) {
-  rapidjson::Value json_violations(rapidjson::kArrayType);
-
-  for (const auto type : violations.types) {
-    rapidjson::Value json_violation(rapidjson::kObjectType);
-    std::string cause;
-    switch (type) {
-      using enum VIOLATION;
-    case LEAD_TIME:
-      cause = "lead_time";
-      json_violation.AddMember("duration", violations.lead_time, allocator);
-      break;
-    case DELAY:
-      cause = "delay";
-      json_violation.AddMember("duration", violations.delay, allocator);
-      break;
-    case LOAD:
-      cause = "load";
-      break;
-    case MAX_TASKS:
-      cause = "max_tasks";
-      break;
-    case SKILLS:
-      cause = "skills";
-      break;
-    case EXCLUSIVE_TAGS:
-      cause = "exclusive_tags";
-      break;
-    case PRECEDENCE:
-      cause = "precedence";
-      break;
-    case MISSING_BREAK:
-      cause = "missing_break";
-      break;
-    case MAX_TRAVEL_TIME:
-      cause = "max_travel_time";
-      break;
-    case MAX_LOAD:
-      cause = "max_load";
-      break;
-    case MAX_DISTANCE:
-      cause = "max_distance";
-      break;
-    default:
-      assert(false);
-    }
+inline std::string get_violation_cause(VIOLATION type) {
+  switch (type) {
+    using enum VIOLATION;
+  case LEAD_TIME:
+    return "lead_time";
+  case DELAY:
+    return "delay";
+  case LOAD:
+    return "load";
+  case MAX_TASKS:
+    return "max_tasks";
+  case SKILLS:
+    return "skills";
+  case EXCLUSIVE_TAGS:
+    return "exclusive_tags";
+  case PRECEDENCE:
+    return "precedence";
+  case MISSING_BREAK:
+    return "missing_break";
+  case MAX_TRAVEL_TIME:
+    return "max_travel_time";
+  case MAX_LOAD:
+    return "max_load";
+  case MAX_DISTANCE:
+    return "max_distance";
+  default:
+    assert(false);
+    return "";
+  }
+}
 
-    json_violation.AddMember("cause", rapidjson::Value(), allocator);
-    json_violation["cause"].SetString(cause.c_str(), cause.size(), allocator);
+inline std::string get_job_type(JOB_TYPE type) {
+  switch (type) {
+    using enum JOB_TYPE;
+  case SINGLE:
+    return "job";
+  case PICKUP:
+    return "pickup";
+  case DELIVERY:
+    return "delivery";
+  }
+  assert(false);
+  return "";
+}
 
-    json_violations.PushBack(json_violation, allocator);
+inline std::string get_step_type(const Step& s) {
+  switch (s.step_type) {
+    using enum STEP_TYPE;
+  case START:
+    return "start";
+  case END:
+    return "end";
+  case BREAK:
+    return "break";
+  case JOB:
+    assert(s.job_type.has_value());
+    return get_job_type(s.job_type.value());
   }
+  assert(false);
+  return "";
+}
 
-  return json_violations;
+template <class Writer, class T> void write_number(Writer& writer, T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    writer.Double(value);
+  } else if constexpr (std::is_signed_v<T>) {
+    writer.Int64(value);
+  } else {
+    writer.Uint64(value);
+  }
 }
 
-rapidjson::Document to_json(const Solution& sol, bool report_distances) {
-  rapidjson::Document json_output;
-  json_output.SetObject();
-  rapidjson::Document::AllocatorType& allocator = json_output.GetAllocator();
+template <class Writer>
+void write_string(Writer& writer, const std::string& str) {
+  writer.String(str.c_str(), static_cast<rapidjson::SizeType>(str.size()));
+}
 
-  json_output.AddMember("code", 0, allocator);
-  json_output.AddMember("summary",
-                        to_json(sol.summary, report_distances, allocator),
-                        allocator);
+template <class Writer>
+void write_amount(Writer& writer, const char* key, const Amount& amount) {
+  writer.Key(key);
+  writer.StartArray();
+  for (std::size_t i = 0; i < amount.size(); ++i) {
+    write_number(writer, amount[i]);
+  }
+  writer.EndArray();
+}
 
-  rapidjson::Value json_unassigned(rapidjson::kArrayType);
-  for (const auto& job : sol.unassigned) {
-    rapidjson::Value json_job(rapidjson::kObjectType);
-    json_job.AddMember("id", job.id, allocator);
-    if (job.location.has_coordinates()) {
-      json_job.AddMember("location",
-                         to_json(job.location, allocator),
-                         allocator);
-    }
-    if (job.location.user_index()) {
-      json_job.AddMember("location_index", job.location.index(), allocator);
+template <class Writer>
+void write_violations(Writer& writer, const Violations& violations) {
+  writer.Key("violations");
+  writer.StartArray();
+  for (const auto type : violations.types) {
+    writer.StartObject();
+    if (type == VIOLATION::LEAD_TIME) {
+      writer.Key("duration");
+      write_number(writer, violations.lead_time);
     }
-    json_job.AddMember("type", rapidjson::Value(), allocator);
-    std::string str_type;
-    switch (job.type) {
-      using enum JOB_TYPE;
-    case SINGLE:
-      str_type = "job";
-      break;
-    case PICKUP:
-      str_type = "pickup";
-      break;
-    case DELIVERY:
-      str_type = "delivery";
-      break;
+    if (type == VIOLATION::DELAY) {
+      writer.Key("duration");
+      write_number(writer, violations.delay);
     }
-    json_job["type"].SetString(str_type.c_str(), str_type.size(), allocator);
+    writer.Key("cause");
+    write_string(writer, get_violation_cause(type));
+    writer.EndObject();
+  }
+  writer.EndArray();
+}
 
-    if (!job.description.empty()) {
-      json_job.AddMember("description", rapidjson::Value(), allocator);
-      json_job["description"].SetString(job.description.c_str(),
-                                        job.description.size(),
-                                        allocator);
-    }
+template <class Writer> void write(Writer& writer, const Location& loc) {
+  writer.StartArray();
+  write_number(writer, loc.lon());
+  write_number(writer, loc.lat());
+  writer.EndArray();
+}
 
-    json_unassigned.PushBack(json_job, allocator);
+template <class Writer> void write(Writer& writer, const ComputingTimes& ct) {
+  writer.StartObject();
+  writer.Key("loading");
+  write_number(writer, ct.loading);
+  writer.Key("solving");
+  write_number(writer, ct.solving);
+  writer.Key("routing");
+  write_number(writer, ct.routing);
+
+  if (ct.matrices.has_value()) {
+    writer.Key("matrices");
+    writer.StartObject();
+    writer.Key("duration");
+    write_number(writer, ct.matrices->duration);
+    writer.Key("overlap");
+    write_number(writer, ct.matrices->overlap);
+    writer.EndObject();
   }
 
-  json_output.AddMember("unassigned", json_unassigned, allocator);
+  if (ct.matrix_cache.has_value()) {
+    writer.Key("matrix_cache");
+    writer.StartObject();
+    writer.Key("hits");
+    write_number(writer, ct.matrix_cache->hits);
+    writer.Key("partial_hits");
+    write_number(writer, ct.matrix_cache->partial_hits);
+    writer.Key("misses");
+    write_number(writer, ct.matrix_cache->misses);
+    writer.EndObject();
+  }
 
-  rapidjson::Value json_routes(rapidjson::kArrayType);
-  for (const auto& route : sol.routes) {
-    json_routes.PushBack(to_json(route, report_distances, allocator),
-                         allocator);
+  writer.EndObject();
+}
+
+template <class Writer>
+void write(Writer& writer, const Summary& summary, bool report_distances) {
+  writer.StartObject();
+
+  writer.Key("cost");
+  write_number(writer, summary.cost);
+  writer.Key("routes");
+  write_number(writer, summary.routes);
+  writer.Key("unassigned");
+  write_number(writer, summary.unassigned);
+
+  if (!summary.delivery.empty()) {
+    write_amount(writer, "delivery", summary.delivery);
+    // Support for deprecated "amount" key.
+    write_amount(writer, "amount", summary.delivery);
   }
 
-  json_output.AddMember("routes", json_routes, allocator);
+  if (!summary.pickup.empty()) {
+    write_amount(writer, "pickup", summary.pickup);
+  }
 
-  return json_output;
-}
+  writer.Key("setup");
+  write_number(writer, summary.setup);
+  writer.Key("service");
+  write_number(writer, summary.service);
+  writer.Key("duration");
+  write_number(writer, summary.duration);
+  writer.Key("waiting_time");
+  write_number(writer, summary.waiting_time);
+  writer.Key("priority");
+  write_number(writer, summary.priority);
 
-rapidjson::Document to_json(const vroom::Exception& e) {
-  rapidjson::Document json_output;
-  json_output.SetObject();
-  rapidjson::Document::AllocatorType& allocator = json_output.GetAllocator();
+  if (report_distances) {
+    writer.Key("distance");
+    write_number(writer, summary.distance);
+  }
 
-  json_output.AddMember("code", e.error_code, allocator);
-  json_output.AddMember("error", rapidjson::Value(), allocator);
-  json_output["error"].SetString(e.message.c_str(), e.message.size());
+  if (summary.merged_locations.has_value()) {
+    writer.Key("merged_locations");
+    write_number(writer, summary.merged_locations.value());
+  }
 
-  return json_output;
+  write_violations(writer, summary.violations);
+
+  writer.Key("computing_times");
+  write(writer, summary.computing_times);
+
+  writer.EndObject();
 }
 
-rapidjson::Value to_json(const Summary& summary,
-                         bool report_distances,
-                         rapidjson::Document::AllocatorType& allocator) {
-  rapidjson::Value json_summary(rapidjson::kObjectType);
+template <class Writer>
+void write(Writer& writer, const Step& s, bool report_distances) {
+  writer.StartObject();
 
-  json_summary.AddMember("cost", summary.cost, allocator);
-  json_summary.AddMember("routes", summary.routes, allocator);
-  json_summary.AddMember("unassigned", summary.unassigned, allocator);
+  writer.Key("type");
+  write_string(writer, get_step_type(s));
 
-  if (!summary.delivery.empty()) {
-    rapidjson::Value json_delivery(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < summary.delivery.size(); ++i) {
-      json_delivery.PushBack(summary.delivery[i], allocator);
+  if (!s.description.empty()) {
+    writer.Key("description");
+    write_string(writer, s.description);
+  }
+
+  if (s.location.has_value()) {
+    const auto& loc = s.location.value();
+    if (loc.has_coordinates()) {
+      writer.Key("location");
+      write(writer, loc);
     }
-    json_summary.AddMember("delivery", json_delivery, allocator);
 
-    // Support for deprecated "amount" key.
-    rapidjson::Value json_amount(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < summary.delivery.size(); ++i) {
-      json_amount.PushBack(summary.delivery[i], allocator);
+    if (loc.user_index()) {
+      writer.Key("location_index");
+      write_number(writer, loc.index());
     }
-    json_summary.AddMember("amount", json_amount, allocator);
   }
 
-  if (!summary.pickup.empty()) {
-    rapidjson::Value json_pickup(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < summary.pickup.size(); ++i) {
-      json_pickup.PushBack(summary.pickup[i], allocator);
-    }
-    json_summary.AddMember("pickup", json_pickup, allocator);
+  if (s.step_type == STEP_TYPE::JOB || s.step_type == STEP_TYPE::BREAK) {
+    writer.Key("id");
+    write_number(writer, s.id);
   }
 
-  json_summary.AddMember("setup", summary.setup, allocator);
-  json_summary.AddMember("service", summary.service, allocator);
-  json_summary.AddMember("duration", summary.duration, allocator);
-  json_summary.AddMember("waiting_time", summary.waiting_time, allocator);
-  json_summary.AddMember("priority", summary.priority, allocator);
+  writer.Key("setup");
+  write_number(writer, s.setup);
+  writer.Key("service");
+  write_number(writer, s.service);
+  writer.Key("waiting_time");
+  write_number(writer, s.waiting_time);
 
-  if (report_distances) {
-    json_summary.AddMember("distance", summary.distance, allocator);
+  // Should be removed at some point as step.job is deprecated.
+  if (s.step_type == STEP_TYPE::JOB) {
+    writer.Key("job");
+    write_number(writer, s.id);
   }
 
-  json_summary.AddMember("violations",
-                         get_violations(summary.violations, allocator),
-                         allocator);
+  if (!s.load.empty()) {
+    write_amount(writer, "load", s.load);
+  }
+
+  writer.Key("arrival");
+  write_number(writer, s.arrival);
+  writer.Key("duration");
+  write_number(writer, s.duration);
+
+  write_violations(writer, s.violations);
 
-  json_summary.AddMember("computing_times",
-                         to_json(summary.computing_times, allocator),
-                         allocator);
+  if (report_distances) {
+    writer.Key("distance");
+    write_number(writer, s.distance);
+  }
 
-  return json_summary;
+  writer.EndObject();
 }
 
-rapidjson::Value to_json(const Route& route,
-                         bool report_distances,
-                         rapidjson::Document::AllocatorType& allocator) {
-  rapidjson::Value json_route(rapidjson::kObjectType);
+template <class Writer>
+void write(Writer& writer, const Route& route, bool report_distances) {
+  writer.StartObject();
 
-  json_route.AddMember("vehicle", route.vehicle, allocator);
-  json_route.AddMember("cost", route.cost, allocator);
+  writer.Key("vehicle");
+  write_number(writer, route.vehicle);
+  writer.Key("cost");
+  write_number(writer, route.cost);
 
   if (!route.description.empty()) {
-    json_route.AddMember("description", rapidjson::Value(), allocator);
-    json_route["description"].SetString(route.description.c_str(),
-                                        route.description.size(),
-                                        allocator);
+    writer.Key("description");
+    write_string(writer, route.description);
   }
 
   if (!route.delivery.empty()) {
-    rapidjson::Value json_delivery(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < route.delivery.size(); ++i) {
-      json_delivery.PushBack(route.delivery[i], allocator);
-    }
-    json_route.AddMember("delivery", json_delivery, allocator);
-
+    write_amount(writer, "delivery", route.delivery);
     // Support for deprecated "amount" key.
-    rapidjson::Value json_amount(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < route.delivery.size(); ++i) {
-      json_amount.PushBack(route.delivery[i], allocator);
-    }
-    json_route.AddMember("amount", json_amount, allocator);
+    write_amount(writer, "amount", route.delivery);
   }
 
   if (!route.pickup.empty()) {
-    rapidjson::Value json_pickup(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < route.pickup.size(); ++i) {
-      json_pickup.PushBack(route.pickup[i], allocator);
-    }
-    json_route.AddMember("pickup", json_pickup, allocator);
+    write_amount(writer, "pickup", route.pickup);
   }
 
-  json_route.AddMember("setup", route.setup, allocator);
-  json_route.AddMember("service", route.service, allocator);
-  json_route.AddMember("duration", route.duration, allocator);
-  json_route.AddMember("waiting_time", route.waiting_time, allocator);
-  json_route.AddMember("priority", route.priority, allocator);
+  writer.Key("setup");
+  write_number(writer, route.setup);
+  writer.Key("service");
+  write_number(writer, route.service);
+  writer.Key("duration");
+  write_number(writer, route.duration);
+  writer.Key("waiting_time");
+  write_number(writer, route.waiting_time);
+  writer.Key("priority");
+  write_number(writer, route.priority);
 
   if (report_distances) {
-    json_route.AddMember("distance", route.distance, allocator);
+    writer.Key("distance");
+    write_number(writer, route.distance);
   }
 
-  rapidjson::Value json_steps(rapidjson::kArrayType);
+  writer.Key("steps");
+  writer.StartArray();
   for (const auto& step : route.steps) {
-    json_steps.PushBack(to_json(step, report_distances, allocator), allocator);
+    write(writer, step, report_distances);
   }
+  writer.EndArray();
 
-  json_route.AddMember("steps", json_steps, allocator);
-
-  json_route.AddMember("violations",
-                       get_violations(route.violations, allocator),
-                       allocator);
+  write_violations(writer, route.violations);
 
   if (!route.geometry.empty()) {
-    json_route.AddMember("geometry", rapidjson::Value(), allocator);
-    json_route["geometry"].SetString(route.geometry.c_str(),
-                                     route.geometry.size());
+    writer.Key("geometry");
+    write_string(writer, route.geometry);
   }
 
-  return json_route;
+  writer.EndObject();
 }
 
-rapidjson::Value to_json(const ComputingTimes& ct,
-                         rapidjson::Document::AllocatorType& allocator) {
-  rapidjson::Value json_ct(rapidjson::kObjectType);
+template <class Writer>
+void write(Writer& writer, const Solution& sol, bool report_distances) {
+  writer.StartObject();
 
-  json_ct.AddMember("loading", ct.loading, allocator);
-  json_ct.AddMember("solving", ct.solving, allocator);
-  json_ct.AddMember("routing", ct.routing, allocator);
+  writer.Key("code");
+  writer.Int(0);
 
-  return json_ct;
-}
+  writer.Key("summary");
+  write(writer, sol.summary, report_distances);
 
-rapidjson::Value to_json(const Step& s,
-                         bool report_distances,
-                         rapidjson::Document::AllocatorType& allocator) {
-  rapidjson::Value json_step(rapidjson::kObjectType);
+  writer.Key("unassigned");
+  writer.StartArray();
+  for (const auto& job : sol.unassigned) {
+    writer.StartObject();
+    writer.Key("id");
+    write_number(writer, job.id);
+    if (job.location.has_coordinates()) {
+      writer.Key("location");
+      write(writer, job.location);
+    }
+    if (job.location.user_index()) {
+      writer.Key("location_index");
+      write_number(writer, job.location.index());
+    }
+    writer.Key("type");
+    write_string(writer, get_job_type(job.type));
+    if (!job.description.empty()) {
+      writer.Key("description");
+      write_string(writer, job.description);
+    }
+    writer.EndObject();
+  }
+  writer.EndArray();
 
-  json_step.AddMember("type", rapidjson::Value(), allocator);
-  std::string str_type;
-  switch (s.step_type) {
-    using enum STEP_TYPE;
-  case START:
-    str_type = "start";
-    break;
-  case END:
-    str_type = "end";
-    break;
-  case BREAK:
-    str_type = "break";
-    break;
-  case JOB: {
-    assert(s.job_type.has_value());
-    switch (s.job_type.value()) {
-      using enum JOB_TYPE;
-    case SINGLE:
-      str_type = "job";
-      break;
-    case PICKUP:
-      str_type = "pickup";
-      break;
-    case DELIVERY:
-      str_type = "delivery";
-      break;
+  writer.Key("routes");
+  writer.StartArray();
+  for (const auto& route : sol.routes) {
+    write(writer, route, report_distances);
+  }
+  writer.EndArray();
+
+  writer.EndObject();
+}
+
+// Handler forwarding writer calls to a document being populated.
+// Documents require member and element counts when closing objects
+// and arrays, which are tracked here. Strings are copied to the
+// document allocator.
+template <class Handler> class CountingHandler {
+private:
+  Handler& _handler;
+  std::vector<rapidjson::SizeType> _counts;
+
+  void add_value() {
+    if (!_counts.empty()) {
+      ++_counts.back();
     }
-    break;
   }
+
+public:
+  explicit CountingHandler(Handler& handler) : _handler(handler) {
   }
-  json_step["type"].SetString(str_type.c_str(), str_type.size(), allocator);
 
-  if (!s.description.empty()) {
-    json_step.AddMember("description", rapidjson::Value(), allocator);
-    json_step["description"].SetString(s.description.c_str(),
-                                       s.description.size(),
-                                       allocator);
+  bool Int(int i) {
+    add_value();
+    return _handler.Int(i);
   }
 
-  if (s.location.has_value()) {
-    const auto& loc = s.location.value();
-    if (loc.has_coordinates()) {
-      json_step.AddMember("location", to_json(loc, allocator), allocator);
-    }
+  bool Int64(int64_t i) {
+    add_value();
+    return _handler.Int64(i);
+  }
 
-    if (loc.user_index()) {
-      json_step.AddMember("location_index", loc.index(), allocator);
-    }
+  bool Uint64(uint64_t u) {
+    add_value();
+    return _handler.Uint64(u);
   }
 
-  if (s.step_type == STEP_TYPE::JOB || s.step_type == STEP_TYPE::BREAK) {
-    json_step.AddMember("id", s.id, allocator);
+  bool Double(double d) {
+    add_value();
+    return _handler.Double(d);
   }
 
-  json_step.AddMember("setup", s.setup, allocator);
-  json_step.AddMember("service", s.service, allocator);
-  json_step.AddMember("waiting_time", s.waiting_time, allocator);
+  bool String(const char* str, rapidjson::SizeType length) {
+    add_value();
+    return _handler.String(str, length, true);
+  }
 
-  // Should be removed at some point as step.job is deprecated.
-  if (s.step_type == STEP_TYPE::JOB) {
-    json_step.AddMember("job", s.id, allocator);
+  bool Key(const char* str) {
+    return _handler.Key(str,
+                        static_cast<rapidjson::SizeType>(std::strlen(str)),
+                        true);
   }
 
-  if (!s.load.empty()) {
-    rapidjson::Value json_load(rapidjson::kArrayType);
-    for (std::size_t i = 0; i < s.load.size(); ++i) {
-      json_load.PushBack(s.load[i], allocator);
-    }
-    json_step.AddMember("load", json_load, allocator);
+  bool StartObject() {
+    add_value();
+    _counts.push_back(0);
+    return _handler.StartObject();
   }
 
-  json_step.AddMember("arrival", s.arrival, allocator);
-  json_step.AddMember("duration", s.duration, allocator);
+  bool EndObject() {
+    const auto nb_members = _counts.back();
+    _counts.pop_back();
+    return _handler.EndObject(nb_members);
+  }
 
-  json_step.AddMember("violations",
-                      get_violations(s.violations, allocator),
-                      allocator);
+  bool StartArray() {
+    add_value();
+    _counts.push_back(0);
+    return _handler.StartArray();
+  }
 
-  if (report_distances) {
-    json_step.AddMember("distance", s.distance, allocator);
+  bool EndArray() {
+    const auto nb_elements = _counts.back();
+    _counts.pop_back();
+    return _handler.EndArray(nb_elements);
   }
+};
+
+// Populate doc from the writer calls in generate, so that documents
+// and streamed output are produced by the same code.
+template <class Generate>
+void populate(rapidjson::Document& doc, Generate&& generate) {
+  auto generator = [&generate](rapidjson::Document& handler) {
+    CountingHandler<rapidjson::Document> counting_handler(handler);
+    generate(counting_handler);
+    return true;
+  };
+  doc.Populate(generator);
+}
+
+template <class Generate>
+rapidjson::Value to_value(Generate&& generate,
+                          rapidjson::Document::AllocatorType& allocator) {
+  rapidjson::Document doc(&allocator);
+  populate(doc, std::forward<Generate>(generate));
 
-  return json_step;
+  rapidjson::Value value;
+  value.Swap(doc);
+  return value;
 }
 
-rapidjson::Value to_json(const Location& loc,
+rapidjson::Document to_json(const Solution& sol, bool report_distances) {
+  rapidjson::Document json_output;
+  populate(json_output, [&](auto& writer) {
+    write(writer, sol, report_distances);
+  });
+  return json_output;
+}
+
+rapidjson::Document to_json(const vroom::Exception& e) {
+  rapidjson::Document json_output;
+  json_output.SetObject();
+  rapidjson::Document::AllocatorType& allocator = json_output.GetAllocator();
+
+  json_output.AddMember("code", e.error_code, allocator);
+  json_output.AddMember("error", rapidjson::Value(), allocator);
+  json_output["error"].SetString(e.message.c_str(), e.message.size());
+
+  return json_output;
+}
+
+rapidjson::Value to_json(const Summary& summary,
+                         bool report_distances,
                          rapidjson::Document::AllocatorType& allocator) {
-  rapidjson::Value json_coords(rapidjson::kArrayType);
+  return to_value(
+    [&](auto& writer) { write(writer, summary, report_distances); },
+    allocator);
+}
 
-  json_coords.PushBack(loc.lon(), allocator);
-  json_coords.PushBack(loc.lat(), allocator);
+rapidjson::Value to_json(const Route& route,
+                         bool report_distances,
+                         rapidjson::Document::AllocatorType& allocator) {
+  return to_value([&](auto& writer) { write(writer, route, report_distances); },
+                  allocator);
+}
 
-  return json_coords;
+rapidjson::Value to_json(const ComputingTimes& ct,
+                         rapidjson::Document::AllocatorType& allocator) {
+  return to_value([&](auto& writer) { write(writer, ct); }, allocator);
 }
 
-void write_to_output(const rapidjson::Document& json_output,
-                     const std::string& output_file) {
-  // Rapidjson writing process.
-  rapidjson::StringBuffer s;
-  rapidjson::Writer<rapidjson::StringBuffer> r_writer(s);
-  json_output.Accept(r_writer);
+rapidjson::Value to_json(const Step& s,
+                         bool report_distances,
+                         rapidjson::Document::AllocatorType& allocator) {
+  return to_value([&](auto& writer) { write(writer, s, report_distances); },
+                  allocator);
+}
+
+rapidjson::Value to_json(const Location& loc,
+                         rapidjson::Document::AllocatorType& allocator) {
+  return to_value([&](auto& writer) { write(writer, loc); }, allocator);
+}
 
-  // Write to relevant output.
+void write_json(const Solution& sol,
+                bool report_distances,
+                std::ostream& out) {
+  rapidjson::OStreamWrapper out_wrapper(out);
+  rapidjson::Writer<rapidjson::OStreamWrapper> writer(out_wrapper);
+  write(writer, sol, report_distances);
+}
+
+// Run serialize on an output stream for the relevant output.
+template <class Serialize>
+void write_to_output(Serialize&& serialize, const std::string& output_file) {
   if (output_file.empty()) {
     // Log to standard output.
-    std::cout << s.GetString() << std::endl;
+    serialize(std::cout);
+    std::cout << std::endl;
   } else {
     // Log to file.
     std::ofstream out_stream(output_file, std::ofstream::out);
-    out_stream << s.GetString();
+    serialize(out_stream);
     out_stream.close();
   }
 }
@@ -403,14 +558,23 @@ void write_to_output(const rapidjson::Document& json_output,
 void write_to_json(const vroom::Exception& e, const std::string& output_file) {
   const auto json_output = to_json(e);
 
-  write_to_output(json_output, output_file);
+  write_to_output(
+    [&json_output](std::ostream& out) {
+      rapidjson::OStreamWrapper out_wrapper(out);
+      rapidjson::Writer<rapidjson::OStreamWrapper> writer(out_wrapper);
+      json_output.Accept(writer);
+    },
+    output_file);
 }
 
 void write_to_json(const Solution& sol,
                    const std::string& output_file,
                    bool report_distances) {
-  const auto json_output = to_json(sol, report_distances);
-
-  write_to_output(json_output, output_file);
+  // Solution is streamed to output without building a document.
+  write_to_output(
+    [&sol, report_distances](std::ostream& out) {
+      write_json(sol, report_distances, out);
+    },
+    output_file);
 }
 } // namespace vroom::io
@@ -10,6 +10,8 @@ All rights reserved (see LICENSE).
 
 */
 
+#include <ostream>
+
 #include "../include/rapidjson/include/rapidjson/document.h"
 #include "structures/vroom/solution/solution.h"
 #include "utils/exception.h"
@@ -38,6 +40,11 @@ rapidjson::Value to_json(const Step& s,
 rapidjson::Value to_json(const Location& loc,
                          rapidjson::Document::AllocatorType& allocator);
 
+// Serialize solution straight to out using a rapidjson writer,
+// without building a document. Output is identical to writing
+// to_json(sol, report_distances).
+void write_json(const Solution& sol, bool report_distances, std::ostream& out);
+
 void write_to_json(const vroom::Exception& e,
                    const std::string& output_file = "");
 
@@ -0,0 +1,74 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include "utils/solution_registry.h"
+
+namespace vroom::utils {
+
+constexpr auto DONE = std::numeric_limits<unsigned>::max();
+
+SolutionRegistry::SolutionRegistry(unsigned nb_searches, bool in_rounds)
+  : _in_rounds(in_rounds), _nb_steps(nb_searches, 0) {
+}
+
+bool SolutionRegistry::found_by_other_search(uint64_t fingerprint,
+                                             unsigned rank,
+                                             unsigned step) {
+  assert(rank < _nb_steps.size());
+  std::unique_lock<std::mutex> lock(_m);
+
+  // References to mapped values remain valid upon insertions.
+  auto& entries = _entries[fingerprint];
+  if (std::ranges::none_of(entries,
+                           [rank](const Entry& e) { return e.rank == rank; })) {
+    entries.push_back({rank, _round, step});
+  }
+
+  if (_in_rounds) {
+    return std::ranges::any_of(entries, [&](const Entry& e) {
+      return e.rank != rank && e.round < _round;
+    });
+  }
+
+  assert(_nb_steps[rank] == step);
+  _nb_steps[rank] = step + 1;
+  _cv.notify_all();
+
+  // Lower-ranked searches are already running or done since searches
+  // are started in rank order, so this wait always ends.
+  _cv.wait(lock, [&] {
+    return std::all_of(_nb_steps.begin(),
+                       _nb_steps.begin() + rank,
+                       [step](const unsigned nb) { return step < nb; });
+  });
+
+  return std::ranges::any_of(entries, [&](const Entry& e) {
+    return e.rank < rank && e.step <= step;
+  });
+}
+
+void SolutionRegistry::finish(unsigned rank) {
+  assert(rank < _nb_steps.size());
+  {
+    const std::scoped_lock<std::mutex> lock(_m);
+    _nb_steps[rank] = DONE;
+  }
+  _cv.notify_all();
+}
+
+void SolutionRegistry::start_round() {
+  const std::scoped_lock<std::mutex> lock(_m);
+  ++_round;
+}
+
+} // namespace vroom::utils
@@ -0,0 +1,91 @@
+#ifndef SOLUTION_REGISTRY_H
+#define SOLUTION_REGISTRY_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vroom::utils {
+
+// Solutions reached by searches after each local search step, so a
+// search reaching a solution already reached by another search can
+// stop there. Only solutions that are registered whatever the thread
+// scheduling are checked against, so which search stops is
+// deterministic:
+// - without rounds, after its k-th step a search waits for all
+// lower-ranked searches to be done with their k-th step, then checks
+// against their solutions from steps up to k;
+// - with rounds, searches check against solutions reached by other
+// searches in earlier rounds.
+class SolutionRegistry {
+private:
+  struct Entry {
+    unsigned rank;
+    unsigned round;
+    unsigned step;
+  };
+
+  const bool _in_rounds;
+  unsigned _round{0};
+
+  std::mutex _m;
+  std::condition_variable _cv;
+
+  // First registration of each solution fingerprint by each search.
+  std::unordered_map<uint64_t, std::vector<Entry>> _entries;
+
+  // Number of steps registered by each search without rounds, set to
+  // max value once search is done.
+  std::vector<unsigned> _nb_steps;
+
+public:
+  SolutionRegistry(unsigned nb_searches, bool in_rounds);
+
+  // Register fingerprint reached by search at rank after given step,
+  // returning true if another search reached it before as defined
+  // above.
+  bool found_by_other_search(uint64_t fingerprint,
+                             unsigned rank,
+                             unsigned step);
+
+  // Has to be called once search at rank is done (or skipped) without
+  // rounds, so higher-ranked searches do not wait on it.
+  void finish(unsigned rank);
+
+  // Solutions registered so far are checked against in next round.
+  void start_round();
+};
+
+inline uint64_t mix_hash(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+// Hash based on jobs order in all routes.
+template <class Route>
+uint64_t get_solution_fingerprint(const std::vector<Route>& sol) {
+  uint64_t seed = sol.size();
+  for (const auto& r : sol) {
+    seed = mix_hash(seed ^ r.route.size());
+    for (const auto j : r.route) {
+      seed = mix_hash(seed ^ j);
+    }
+  }
+  return seed;
+}
+
+} // namespace vroom::utils
+
+#endif
@@ -0,0 +1,140 @@
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+#include "utils/thread_pool.h"
+
+namespace vroom::utils {
+
+namespace {
+
+struct ParallelForState {
+  const std::size_t n;
+  const std::function<void(std::size_t)>& f;
+  std::atomic<std::size_t> next{0};
+
+  std::mutex done_m;
+  std::condition_variable done_cv;
+  std::size_t done{0};
+  std::exception_ptr ep{nullptr};
+
+  ParallelForState(std::size_t n, const std::function<void(std::size_t)>& f)
+    : n(n), f(f) {
+  }
+
+  void run() {
+    std::size_t local_done = 0;
+    std::exception_ptr local_ep = nullptr;
+
+    // f is only accessed after claiming a valid iteration, which
+    // guarantees the caller is still waiting.
+    for (auto i = next++; i < n; i = next++) {
+      try {
+        f(i);
+      } catch (...) {
+        local_ep = std::current_exception();
+      }
+      ++local_done;
+    }
+
+    if (local_done > 0) {
+      const std::scoped_lock<std::mutex> lock(done_m);
+      done += local_done;
+      if (ep == nullptr) {
+        ep = local_ep;
+      }
+      if (done == n) {
+        done_cv.notify_all();
+      }
+    }
+  }
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned nb_workers) {
+  _workers.reserve(nb_workers);
+  for (unsigned i = 0; i < nb_workers; ++i) {
+    _workers.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const std::scoped_lock<std::mutex> lock(_tasks_m);
+    _stop = true;
+  }
+  _tasks_cv.notify_all();
+
+  for (auto& w : _workers) {
+    w.join();
+  }
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_tasks_m);
+      _tasks_cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+
+      if (_tasks.empty()) {
+        // Only reached when stopping.
+        return;
+      }
+
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+void ThreadPool::submit(std::function<void()>&& task) {
+  {
+    const std::scoped_lock<std::mutex> lock(_tasks_m);
+    _tasks.push_back(std::move(task));
+  }
+  _tasks_cv.notify_one();
+}
+
+void ThreadPool::parallel_for(std::size_t n,
+                              const std::function<void(std::size_t)>& f,
+                              std::size_t max_threads) {
+  if (_workers.empty() || n < 2 || max_threads < 2) {
+    for (std::size_t i = 0; i < n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>(n, f);
+
+  const auto nb_helpers =
+    std::min({n - 1, _workers.size(), max_threads - 1});
+  for (std::size_t i = 0; i < nb_helpers; ++i) {
+    submit([state] { state->run(); });
+  }
+
+  state->run();
+
+  std::unique_lock<std::mutex> lock(state->done_m);
+  state->done_cv.wait(lock, [&state] { return state->done == state->n; });
+
+  if (state->ep != nullptr) {
+    std::rethrow_exception(state->ep);
+  }
+}
+
+} // namespace vroom::utils
@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/*
+
+This file is part of VROOM.
+
+Copyright (c) 2015-2025, Julien Coupey.
+All rights reserved (see LICENSE).
+
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vroom::utils {
+
+class ThreadPool {
+private:
+  std::vector<std::thread> _workers;
+  std::deque<std::function<void()>> _tasks;
+  std::mutex _tasks_m;
+  std::condition_variable _tasks_cv;
+  bool _stop{false};
+
+  void work();
+
+public:
+  explicit ThreadPool(unsigned nb_workers);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  unsigned nb_workers() const {
+    return _workers.size();
+  }
+
+  void submit(std::function<void()>&& task);
+
+  // Run f(i) for all i in [0, n) using at most max_threads threads,
+  // including the calling thread that takes part in the work.
+  // Iterations are picked up one at a time by whichever thread is
+  // available, so this never waits on workers that are busy
+  // elsewhere. Any exception thrown by f is rethrown here.
+  void parallel_for(std::size_t n,
+                    const std::function<void(std::size_t)>& f,
+                    std::size_t max_threads =
+                      std::numeric_limits<std::size_t>::max());
+};
+
+} // namespace vroom::utils
+
+#endif